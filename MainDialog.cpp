@@ -11,7 +11,7 @@
 MainDialog* MainDialog::instance_ = nullptr;
 
 MainDialog::MainDialog() : hwnd_(nullptr), audio_processor_(std::make_unique<AudioProcessor>()), 
-    worker_thread_(nullptr), is_processing_(false), active_threads_(0), completed_files_(0),
+    worker_thread_(nullptr), is_processing_(false), next_worker_index_(0), active_threads_(0), completed_files_(0),
     error_files_(0), total_files_(0), max_threads_(1), shutdown_threads_(false) {
     instance_ = this;
 }
@@ -27,6 +27,9 @@ MainDialog::~MainDialog() {
     
     // ر̳߳
     ShutdownThreadPool();
+
+    // ֹ̨ͣĿ¼ɨ
+    scanner_.reset();
     
     instance_ = nullptr;
 }
@@ -49,12 +52,6 @@ bool MainDialog::Create(HINSTANCE hInstance) {
     return true;
 }
 
-// б½ṹ
-struct ListItemUpdate {
-    int item_index;
-    int sub_item_index;
-    std::wstring* text;
-};
 // GUI
 INT_PTR CALLBACK MainDialog::DialogProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
     if (message == WM_INITDIALOG) {
@@ -103,22 +100,23 @@ INT_PTR CALLBACK MainDialog::DialogProc(HWND hwnd, UINT message, WPARAM wParam,
             // }
             return TRUE;
         }
-        // бϢ
-        case WM_USER + 4: {
-            // б
-            ListItemUpdate* update_info = reinterpret_cast<ListItemUpdate*>(wParam);
-            if (update_info && update_info->text) {
-                // бı
-                LVITEM lvi = { 0 };
-                lvi.mask = LVIF_TEXT;
-                lvi.iItem = update_info->item_index;
-                lvi.iSubItem = update_info->sub_item_index;
-                lvi.pszText = const_cast<LPWSTR>(update_info->text->c_str());
-                ListView_SetItem(dlg->list_view_, &lvi);
-                
-                // ͷڴ
-                delete update_info->text;
-                delete update_info;
+        // ̨Ŀ¼ɨҵһļ
+        case WM_USER + 5: {
+            std::vector<DirectoryScanner::Entry>* files = reinterpret_cast<std::vector<DirectoryScanner::Entry>*>(wParam);
+            if (files) {
+                // ڼͣػ
+                SendMessage(dlg->list_view_, WM_SETREDRAW, FALSE, 0);
+                for (const auto& file : *files) {
+                    dlg->AddFileToList(file.path, file.size);
+                }
+                SendMessage(dlg->list_view_, WM_SETREDRAW, TRUE, 0);
+                delete files;
+
+                if (!dlg->is_processing_) {
+                    WCHAR status[64];
+                    swprintf_s(status, L"ѵ %zu ļ", dlg->file_list_.Size());
+                    dlg->UpdateStatus(status);
+                }
             }
             return TRUE;
         }
@@ -168,22 +166,25 @@ INT_PTR MainDialog::OnNotify(WPARAM wParam, LPARAM lParam) {
                 // ʾ˵ѡ
                 int cmd = TrackPopupMenu(hPopupMenu, TPM_RETURNCMD | TPM_LEFTALIGN | TPM_RIGHTBUTTON,
                                         pt.x, pt.y, 0, hwnd_, nullptr);
-                if (cmd == 1) {
+                if (cmd == 1 && is_processing_) {
+                    // еб±궨λбУǰɾ
+                    MessageBox(hwnd_, L"ڴļȴǰ", L"ʾ", MB_OK | MB_ICONINFORMATION);
+                } else if (cmd == 1) {
                     // ӺǰɾѡԱ仯
-                    std::vector<int> selectedItems;
+                    std::vector<size_t> selectedItems;
                     int item = -1;
                     while ((item = ListView_GetNextItem(list_view_, item, LVNI_SELECTED)) != -1) {
-                        selectedItems.push_back(item);
+                        selectedItems.push_back(static_cast<size_t>(item));
                     }
 
                     // ӴС
                     std::sort(selectedItems.rbegin(), selectedItems.rend());
 
-                    // ɾѡе
-                    for (int index : selectedItems) {
-                        ListView_DeleteItem(list_view_, index);
-                        file_list_.erase(file_list_.begin() + index);
+                    // ɾѡеļбһαɾ
+                    for (size_t index : selectedItems) {
+                        ListView_DeleteItem(list_view_, static_cast<int>(index));
                     }
+                    file_list_.Remove(selectedItems);
                 }
 
                 DestroyMenu(hPopupMenu);
@@ -196,38 +197,11 @@ INT_PTR MainDialog::OnNotify(WPARAM wParam, LPARAM lParam) {
 //ʱ, ٸ״̬ı
 INT_PTR MainDialog::OnTimer(WPARAM wParam) {
     if (wParam == 1) { // ȸ¶ʱ
-        // 
-        int overall_progress = 0;
-        if (total_files_ > 0) {
-            // ļܽ
-            double total_progress = 0.0;
-            int file_count = 0;
-            
-            // ӳ䣬ֹ̳߳ͻ
-            std::lock_guard<std::mutex> lock(progress_mutex_);
-            
-            // ļĽ
-            for (const auto& progress_pair : file_progress_) {
-                // ÿļĽȰٷֱתΪСۼ
-                total_progress += progress_pair.second / 100.0;
-                file_count++;
-            }
-            
-            // ȣļ֮ͳļ
-            if (file_count > 0) {
-                // ܽתΪٷֱ
-                overall_progress = static_cast<int>((total_progress / total_files_) * 100);
-            } else {
-                // ûļϢʹļ
-                overall_progress = static_cast<int>((completed_files_ * 100) / total_files_);
-            }
-            
-            // ȷȲ100%
-            if (overall_progress > 100) overall_progress = 100;
-        }
-        
-        // ½
-        UpdateProgress(overall_progress);
+        // ӽȱȡգб仯б
+        UpdateFileProgress();
+
+        // ½ļ֮ͳļ
+        UpdateProgress(file_progress_.OverallPercent());
         
         // ״̬ı - ʾϸĽϢ
         // std::wstring status = L"ڴļ... " + std::to_wstring(completed_files_) + L"/" + std::to_wstring(total_files_);
@@ -251,6 +225,10 @@ INT_PTR MainDialog::OnTimer(WPARAM wParam) {
                     worker_thread_ = nullptr;
                     is_processing_ = false;
                     KillTimer(hwnd_, 1);
+
+                    // һο֮ɵļҲҪʾ
+                    UpdateFileProgress();
+                    UpdateProgress(file_progress_.OverallPercent());
                     
                     // ܺʱ
                     // LARGE_INTEGER end_time, frequency;
@@ -304,39 +282,8 @@ void MainDialog::ImportFile() {
                             PWSTR filePath;
                             hr = pItem->GetDisplayName(SIGDN_FILESYSPATH, &filePath);
                             if (SUCCEEDED(hr)) {
-                                // ļб
-                                file_list_.push_back(filePath);
-                                
-                                // бͼ
-                                LVITEM lvi = { 0 };
-                                lvi.mask = LVIF_TEXT;
-                                lvi.iItem = ListView_GetItemCount(list_view_);
-                                lvi.iSubItem = 0;
-                                lvi.pszText = PathFindFileName(filePath);
-                                ListView_InsertItem(list_view_, &lvi);
-
-                                // ȡļСʽ
-                                WIN32_FILE_ATTRIBUTE_DATA fileAttr;
-                                if (GetFileAttributesEx(filePath, GetFileExInfoStandard, &fileAttr)) {
-                                    ULARGE_INTEGER fileSize;
-                                    fileSize.HighPart = fileAttr.nFileSizeHigh;
-                                    fileSize.LowPart = fileAttr.nFileSizeLow;
-                                    
-                                    WCHAR sizeBuf[32];
-                                    if (fileSize.QuadPart < 1024) {
-                                        swprintf_s(sizeBuf, L"%llu B", fileSize.QuadPart);
-                                    } else if (fileSize.QuadPart < 1024 * 1024) {
-                                        swprintf_s(sizeBuf, L"%.2f KB", fileSize.QuadPart / 1024.0);
-                                    } else if (fileSize.QuadPart < 1024 * 1024 * 1024) {
-                                        swprintf_s(sizeBuf, L"%.2f MB", fileSize.QuadPart / (1024.0 * 1024.0));
-                                    } else {
-                                        swprintf_s(sizeBuf, L"%.2f GB", fileSize.QuadPart / (1024.0 * 1024.0 * 1024.0));
-                                    }
-
-                                    lvi.iSubItem = 1;
-                                    lvi.pszText = sizeBuf;
-                                    ListView_SetItem(list_view_, &lvi);
-                                }
+                                // ļбѴڵļ
+                                AddFileToList(filePath);
 
                                 CoTaskMemFree(filePath);
                             }
@@ -352,29 +299,11 @@ void MainDialog::ImportFile() {
 }
 //ʼť
 void MainDialog::SplitChannels() {
-    if (file_list_.empty()) {
+    if (file_list_.Empty()) {
         MessageBox(hwnd_, L"ȵļ", L"ʾ", MB_OK | MB_ICONINFORMATION);
         return;
     }
 
-    // ļΪ0%
-    for (int i = 0; i < file_list_.size(); ++i) {
-        // ȸ½ṹ
-        ListItemUpdate* update_info = new ListItemUpdate;
-        update_info->item_index = i;
-        update_info->sub_item_index = 2; // 
-        update_info->text = new std::wstring(L"0%");
-        
-        // Ϣб
-        PostMessage(hwnd_, WM_USER + 4, reinterpret_cast<WPARAM>(update_info), 0);
-    }
-
-    // սȼ¼
-    {
-        std::lock_guard<std::mutex> lock(progress_mutex_);
-        file_progress_.clear();
-    }
-
     // ѾڴУҪظ
     if (is_processing_) {
         MessageBox(hwnd_, L"ڴļȴǰ", L"ʾ", MB_OK | MB_ICONINFORMATION);
@@ -440,6 +369,24 @@ void MainDialog::SplitChannels() {
     format.num_channels = num_channels > 0 ? num_channels : 2;
     audio_processor_->SetAudioFormat(format);
 
+    // ͨӳ䣬ʱÿͨһļ
+    WCHAR channel_map_text[256];
+    GetDlgItemText(hwnd_, IDC_CHANNEL_MAP_EDIT, channel_map_text, 256);
+    AudioProcessor::ChannelMap channel_map;
+    if (!AudioProcessor::ParseChannelMap(channel_map_text, channel_map)) {
+        MessageBox(hwnd_, L"ͨʽ硰1,31+2,3ձʾȫͨ", L"", MB_OK | MB_ICONERROR);
+        return;
+    }
+    for (const auto& channels : channel_map) {
+        for (int ch : channels) {
+            if (ch >= format.num_channels) {
+                MessageBox(hwnd_, L"ͨͨ", L"", MB_OK | MB_ICONERROR);
+                return;
+            }
+        }
+    }
+    audio_processor_->SetChannelMap(channel_map);
+
     // ý
     SendMessage(progress_bar_, PBM_SETPOS, 0, 0);
     
@@ -449,6 +396,18 @@ void MainDialog::SplitChannels() {
     AudioProcessor::OutputFormat audio_output_format = output_format == 0 ? 
         AudioProcessor::OutputFormat::WAV : AudioProcessor::OutputFormat::PCM;
     audio_processor_->SetOutputFormat(audio_output_format);
+
+    // ȡʽͶã˳SampleFormatһ
+    HWND sample_format_combo = GetDlgItem(hwnd_, IDC_SAMPLE_FORMAT);
+    int sample_format = ComboBox_GetCurSel(sample_format_combo);
+    audio_processor_->SetSampleFormat(sample_format > 0 ?
+        static_cast<AudioProcessor::SampleFormat>(sample_format) : AudioProcessor::SampleFormat::Source);
+    audio_processor_->SetDither(IsDlgButtonChecked(hwnd_, IDC_DITHER_CHECK) == BST_CHECKED);
+    // ѡͨͳʱÿļдJSONͳļ
+    audio_processor_->SetStatsMode(IsDlgButtonChecked(hwnd_, IDC_STATS_CHECK) == BST_CHECKED ?
+        AudioProcessor::StatsMode::Json : AudioProcessor::StatsMode::Off);
+    // ѡͨʱȫΪͨļ
+    audio_processor_->SetSkipSilentOutputs(IsDlgButtonChecked(hwnd_, IDC_SKIP_SILENT_CHECK) == BST_CHECKED);
     
     // ȡ߳ãĬΪ5
     int thread_count = GetDlgItemInt(hwnd_, IDC_THREAD_COUNT, nullptr, FALSE);
@@ -466,7 +425,18 @@ void MainDialog::SplitChannels() {
     // ü
     completed_files_ = 0;
     error_files_ = 0;
-    total_files_ = static_cast<int>(file_list_.size());
+    // ̨ɨڴڼļֻʼʱбеļ
+    batch_files_.assign(file_list_.begin(), file_list_.end());
+    total_files_ = static_cast<int>(batch_files_.size());
+    run_metrics_.Reset();
+
+    // ļΪ0%߳ǰɣֻ֮д
+    file_progress_.Reset(batch_files_.size());
+    shown_progress_.assign(batch_files_.size(), 0);
+    shown_progress_version_ = file_progress_.Version();
+    for (int i = 0; i < static_cast<int>(batch_files_.size()); ++i) {
+        SetFileProgressText(i, 0);
+    }
     
     // ̴߳ļ
     worker_thread_ = CreateThread(
@@ -506,25 +476,54 @@ DWORD WINAPI MainDialog::ProcessFilesThreadProc(LPVOID lpParam) {
     // ״̬
     // PostMessage(dlg->hwnd_, WM_USER + 2, reinterpret_cast<WPARAM>(new std::wstring(L"׼ļ...")), 0);
     
-    // ļӵ
-    for (const auto& file : dlg->file_list_) {
+    // ȡ׺
+    WCHAR suffix[256];
+    GetDlgItemText(dlg->hwnd_, IDC_SUFFIX_EDIT, suffix, 256);
+
+    // нļļͷõdataСʱȡƵ
+    PostMessage(dlg->hwnd_, WM_USER + 2, reinterpret_cast<WPARAM>(new std::wstring(L"ڶȡļϢ...")), 0);
+    std::vector<AudioProcessor::ProbeInfo> probes =
+        AudioProcessor::ProbeFiles(dlg->batch_files_, format, dlg->max_threads_);
+    uint64_t total_bytes = 0;
+    double total_seconds = 0.0;
+    for (const auto& probe : probes) {
+        total_bytes += probe.data_size;
+        total_seconds += probe.duration_seconds;
+    }
+
+    // ļͬdataСһύļȴܽȰͬĴСȨ
+    std::vector<FileScheduler<FileTask>::Item> items;
+    items.reserve(dlg->batch_files_.size());
+    for (size_t file_id = 0; file_id < dlg->batch_files_.size(); ++file_id) {
+        const std::wstring& file = dlg->batch_files_[file_id];
         // ȡļĿ¼ΪĿ¼
         std::wstring output_dir = std::filesystem::path(file).parent_path().wstring();
-        
-        // ȡ׺
-        WCHAR suffix[256];
-        GetDlgItemText(dlg->hwnd_, IDC_SUFFIX_EDIT, suffix, 256);
-
-        // ӵ
-        FileTask task;
-        task.file_path = file;
-        task.output_dir = output_dir;
-        task.format = format;
-        task.output_format = output_format;
-        task.suffix = suffix;
-        
-        dlg->AddTask(task);
+
+        // 
+        FileScheduler<FileTask>::Item item;
+        item.task.file_id = file_id;
+        item.task.file_path = file;
+        item.task.output_dir = output_dir;
+        item.task.format = format;
+        item.task.output_format = output_format;
+        item.task.suffix = suffix;
+        item.task.channel_map = dlg->audio_processor_->GetChannelMap();
+        item.task.sample_format = dlg->audio_processor_->GetSampleFormat();
+        item.task.dither = dlg->audio_processor_->GetDither();
+        item.task.stats_mode = dlg->audio_processor_->GetStatsMode();
+        item.task.skip_silent = dlg->audio_processor_->GetSkipSilentOutputs();
+
+        // ļͷЧļܿʧܣļС
+        const AudioProcessor::ProbeInfo& probe = probes[file_id];
+        item.size = probe.valid ? probe.data_size : probe.file_size;
+        dlg->file_progress_.SetWeight(file_id, item.size);
+
+        items.push_back(std::move(item));
     }
+    dlg->scheduler_.Submit(std::move(items));
+
+    // ύд߳Զ˳
+    dlg->scheduler_.Close();
     
     // ״̬
     // PostMessage(dlg->hwnd_, WM_USER + 2, reinterpret_cast<WPARAM>(new std::wstring(L"ڴļ...")), 0);
@@ -533,12 +532,13 @@ DWORD WINAPI MainDialog::ProcessFilesThreadProc(LPVOID lpParam) {
     while (dlg->completed_files_ < dlg->total_files_ && !dlg->shutdown_threads_) {
         Sleep(200); // ÿ100һ
         
-        // 
-        int overall_progress = static_cast<int>((dlg->completed_files_ * 100) / dlg->total_files_);
-        PostMessage(dlg->hwnd_, WM_USER + 1, static_cast<WPARAM>(overall_progress), 0);
+        // ȣļdataСȨ
+        PostMessage(dlg->hwnd_, WM_USER + 1, static_cast<WPARAM>(dlg->file_progress_.OverallPercent()), 0);
         
-        // ״̬ıɹʧļ
+        // ״̬ıʱԼɹʧļ
         std::wstring status = L"ڴļ... " + std::to_wstring(dlg->completed_files_) + L"/" + std::to_wstring(dlg->total_files_);
+        status += L" " + std::to_wstring(total_bytes / (1024 * 1024)) + L" MB" +
+                  std::to_wstring(static_cast<long long>(total_seconds)) + L" Ƶ";
         if (dlg->error_files_ > 0) {
             status += L" (ɹ: " + std::to_wstring(dlg->completed_files_ - dlg->error_files_) + 
                      L", ʧ: " + std::to_wstring(dlg->error_files_) + L")";
@@ -559,38 +559,21 @@ DWORD WINAPI MainDialog::ProcessFilesThreadProc(LPVOID lpParam) {
         status += L" (ɹ: " + std::to_wstring(dlg->completed_files_ - dlg->error_files_) + 
                  L", ʧ: " + std::to_wstring(dlg->error_files_) + L")";
     }
+
+    // ׶κʱ߳ۼƣжƿڶȡͨ뻹д
+    SplitMetrics metrics = dlg->run_metrics_.Total();
+    WCHAR stage_text[128];
+    swprintf_s(stage_text, L"ȡ %.1f 룬 %.1f 룬д %.1f ",
+               metrics.load_seconds + metrics.read_seconds, metrics.deinterleave_seconds, metrics.write_seconds);
+    status += stage_text;
     PostMessage(dlg->hwnd_, WM_USER + 2, reinterpret_cast<WPARAM>(new std::wstring(status)), 0);
     
     return 0;
 }
 
-// 񵽶
-void MainDialog::AddTask(const FileTask& task) {
-    {
-        std::lock_guard<std::mutex> lock(task_mutex_);
-        task_queue_.push(task);
-    }
-    task_cv_.notify_one();
-}
-
-// ȡӶ
-bool MainDialog::GetTask(FileTask& task) {
-    std::unique_lock<std::mutex> lock(task_mutex_);
-    
-    // ȴرź
-    task_cv_.wait(lock, [this] {
-        return !task_queue_.empty() || shutdown_threads_;
-    });
-    
-    // յرźҶΪգfalse
-    if (task_queue_.empty()) {
-        return false;
-    }
-    
-    // ȡ
-    task = task_queue_.front();
-    task_queue_.pop();
-    return true;
+// ȡûʱȴرջ̳߳عرʱfalse
+bool MainDialog::GetTask(int worker_index, FileTask& task) {
+    return scheduler_.Next(worker_index, task);
 }
 
 // ̺߳еļ
@@ -600,108 +583,68 @@ DWORD WINAPI MainDialog::WorkerThreadProc(LPVOID lpParam) {
     
     // ÿ߳ԼAudioProcessorʵ
     std::unique_ptr<AudioProcessor> thread_audio_processor = std::make_unique<AudioProcessor>();
-    
+
+    // ʹʽ룬ڴռļС޹
+    thread_audio_processor->SetInputMode(AudioProcessor::InputMode::Stream);
+
     // ýȻص - ʼصֻڵĿ
     thread_audio_processor->SetProgressCallback([dlg](int progress) {
         // ½ȣÿļרûصи
     });
+
+    // ÿļֽܸ׶ͳ
+    thread_audio_processor->SetMetricsCallback([dlg](const SplitMetrics& metrics) {
+        dlg->run_metrics_.Add(metrics);
+    });
     
+    // ÿ̶߳Ӧеһ
+    int worker_index = dlg->next_worker_index_++;
+
     // ѭе
     FileTask task;
-    while (dlg->GetTask(task)) {
+    while (dlg->GetTask(worker_index, task)) {
         // ӻ̼߳
         dlg->active_threads_++;
         
-        // ȡļбе
+        // ȡļбекһύҪٲ
         std::wstring filename = std::filesystem::path(task.file_path).filename().wstring();
-        int file_index = -1;
-        
-        // ļбе
-        for (int i = 0; i < dlg->file_list_.size(); i++) {
-            if (std::filesystem::path(dlg->file_list_[i]).filename().wstring() == filename) {
-                file_index = i;
-                break;
-            }
-        }
-        
-        // ʼΪ0%
-        if (file_index >= 0) {
-            // ʹPostMessageбĽ
-            WCHAR progress_text[16];
-            swprintf_s(progress_text, L"0%%");
-            
-            // һṹݸϢ
-            struct ListItemUpdate* update_info = new ListItemUpdate;
-            update_info->item_index = file_index;
-            update_info->sub_item_index = 2; // 
-            update_info->text = new std::wstring(progress_text);
-            
-            // Ϣб
-            PostMessage(dlg->hwnd_, WM_USER + 4, reinterpret_cast<WPARAM>(update_info), 0);
-            
-            // ʼļ
-            std::lock_guard<std::mutex> lock(dlg->progress_mutex_);
-            dlg->file_progress_[task.file_path] = 0;
-        }
+        size_t file_index = task.file_id;
         
-        // ļ
+        // ļPCMļͷõĸʽ
+        thread_audio_processor->SetAudioFormat(task.format);
         if (!thread_audio_processor->LoadWavFile(task.file_path)) {
             // ʹϢ
             std::wstring error_msg = L"޷Ƶļ: " + filename;
             PostMessage(dlg->hwnd_, WM_USER + 3, reinterpret_cast<WPARAM>(new std::wstring(error_msg)), 0);
             
-            // бʾϢ
-            if (file_index >= 0) {
-                // һṹݸϢ
-                struct ListItemUpdate* update_info = new ListItemUpdate;
-                update_info->item_index = file_index;
-                update_info->sub_item_index = 2; // 
-                update_info->text = new std::wstring(L"ʧ");
-                
-                // Ϣб
-                PostMessage(dlg->hwnd_, WM_USER + 4, reinterpret_cast<WPARAM>(update_info), 0);
-            }
+            // бʾϢʧļܽа100%
+            dlg->file_progress_.Set(file_index, ProgressRegistry::kLoadFailed);
             
             // Ӵļ
             dlg->error_files_++;
-            
-            // ʧļĽΪ100%ȷܽȼȷ
-            std::lock_guard<std::mutex> lock(dlg->progress_mutex_);
-            dlg->file_progress_[task.file_path] = 100;
         } else {
             // Ƶʽ
             thread_audio_processor->SetAudioFormat(task.format);
             thread_audio_processor->SetOutputFormat(task.output_format);
+            thread_audio_processor->SetChannelMap(task.channel_map);
+            thread_audio_processor->SetSampleFormat(task.sample_format);
+            thread_audio_processor->SetDither(task.dither);
+            thread_audio_processor->SetStatsMode(task.stats_mode);
+            thread_audio_processor->SetSkipSilentOutputs(task.skip_silent);
+            // еĲʼĿʣWAVļĲ֮ͬʱزPCM밴òʶȡز
+            thread_audio_processor->SetOutputSampleRate(task.format.sample_rate);
+
+            // ļ߳ʱе߳ڵļڲĲв
+            thread_audio_processor->SetSplitThreads((std::max)(1, dlg->max_threads_ / (std::max)(1, dlg->total_files_.load())));
             
             // ״̬Ϣ
             // std::wstring status_msg = L"ڴ: " + filename;
             // PostMessage(dlg->hwnd_, WM_USER + 2, reinterpret_cast<WPARAM>(new std::wstring(status_msg)), 0);
             
             // ýȻصڸضļĽ
-            thread_audio_processor->SetProgressCallback([dlg, task, file_index](int progress) {
-                // ļ - ʹûȷ̰߳ȫ
-                {
-                    std::lock_guard<std::mutex> lock(dlg->progress_mutex_);
-                    dlg->file_progress_[task.file_path] = progress;
-                }
-                
-                // ҵļб
-                if (file_index >= 0) {
-                    // ʽı
-                    WCHAR progress_text[16];
-                    swprintf_s(progress_text, L"%d%%", progress);
-                    
-                    // һṹݸϢ
-                    struct ListItemUpdate* update_info = new ListItemUpdate;
-                    update_info->item_index = file_index;
-                    update_info->sub_item_index = 2; // 
-                    update_info->text = new std::wstring(progress_text);
-                    
-                    // Ϣб
-                    PostMessage(dlg->hwnd_, WM_USER + 4, reinterpret_cast<WPARAM>(update_info), 0);
-                }
-                
-                // ﴥܽȸ£ʱͳһ
+            thread_audio_processor->SetProgressCallback([dlg, file_index](int progress) {
+                // дȱбܽɶʱͳһ
+                dlg->file_progress_.Set(file_index, progress);
             });
             
             // ִͨ
@@ -710,42 +653,15 @@ DWORD WINAPI MainDialog::WorkerThreadProc(LPVOID lpParam) {
                 std::wstring error_msg = L"Ƶļʧ: " + filename;
                 PostMessage(dlg->hwnd_, WM_USER + 3, reinterpret_cast<WPARAM>(new std::wstring(error_msg)), 0);
                 
-                // бʾϢ
-                if (file_index >= 0) {
-                    // һṹݸϢ
-                    struct ListItemUpdate* update_info = new ListItemUpdate;
-                    update_info->item_index = file_index;
-                    update_info->sub_item_index = 2; // 
-                    update_info->text = new std::wstring(L"ʧ");
-                    
-                    // Ϣб
-                    PostMessage(dlg->hwnd_, WM_USER + 4, reinterpret_cast<WPARAM>(update_info), 0);
-                }
+                // бʾϢʧļܽа100%
+                dlg->file_progress_.Set(file_index, ProgressRegistry::kSplitFailed);
                 
                 // Ӵļ
                 dlg->error_files_++;
-                
-                // ʧļĽΪ100%ȷܽȼȷ
-                std::lock_guard<std::mutex> lock(dlg->progress_mutex_);
-                dlg->file_progress_[task.file_path] = 100;
             }
-            else if (file_index >= 0) {
-                // ɹýΪ100%
-                WCHAR progress_text[16];
-                swprintf_s(progress_text, L"100%%");
-                
-                // һṹݸϢ
-                struct ListItemUpdate* update_info = new ListItemUpdate;
-                update_info->item_index = file_index;
-                update_info->sub_item_index = 2; // 
-                update_info->text = new std::wstring(progress_text);
-                
-                // Ϣб
-                PostMessage(dlg->hwnd_, WM_USER + 4, reinterpret_cast<WPARAM>(update_info), 0);
-                
-                // ȷļΪ100%
-                std::lock_guard<std::mutex> lock(dlg->progress_mutex_);
-                dlg->file_progress_[task.file_path] = 100;
+            else {
+                // ɹȷļΪ100%
+                dlg->file_progress_.Set(file_index, 100);
             }
         }
         
@@ -809,6 +725,42 @@ void MainDialog::UpdateProgress(int progress) {
     SendMessage(progress_bar_, PBM_SETPOS, progress, 0);
 }
 
+// ѽȱб仯ļдб
+void MainDialog::UpdateFileProgress() {
+    uint64_t version = file_progress_.Version();
+    if (version == shown_progress_version_) {
+        return;
+    }
+
+    // ջ֮临ãʱвڴ
+    shown_progress_version_ = file_progress_.Snapshot(progress_snapshot_);
+    for (size_t i = 0; i < progress_snapshot_.size() && i < shown_progress_.size(); ++i) {
+        if (progress_snapshot_[i] != shown_progress_[i]) {
+            shown_progress_[i] = progress_snapshot_[i];
+            SetFileProgressText(static_cast<int>(i), progress_snapshot_[i]);
+        }
+    }
+}
+
+// бĳһеĽ
+void MainDialog::SetFileProgressText(int index, int value) {
+    WCHAR progress_text[16];
+    if (value == ProgressRegistry::kLoadFailed) {
+        wcscpy_s(progress_text, L"ʧ");
+    } else if (value == ProgressRegistry::kSplitFailed) {
+        wcscpy_s(progress_text, L"ʧ");
+    } else {
+        swprintf_s(progress_text, L"%d%%", value);
+    }
+
+    LVITEM lvi = { 0 };
+    lvi.mask = LVIF_TEXT;
+    lvi.iItem = index;
+    lvi.iSubItem = 2; // 
+    lvi.pszText = progress_text;
+    ListView_SetItem(list_view_, &lvi);
+}
+
 void MainDialog::UpdateStatus(const std::wstring& status) {
 	//ȡǰ״̬ıǰ״̬ıµ״̬ıͬ򲻸
 	WCHAR current_status[256];
@@ -854,54 +806,45 @@ INT_PTR MainDialog::OnDropFiles(WPARAM wParam) {
     return TRUE;
 }
 
-// ݹ鴦Ϸŵļ
+// ں̨߳еݹɨϷŵļУҵļؽ̼߳бɨڼ治Ῠס
 void MainDialog::ProcessDroppedFolder(const std::wstring& folderPath) {
-    // ·
-    std::wstring searchPath = folderPath + L"\\*";
-    
-    // ҵһļ
-    WIN32_FIND_DATA findData;
-    HANDLE hFind = FindFirstFile(searchPath.c_str(), &findData);
-    
-    if (hFind != INVALID_HANDLE_VALUE) {
-        do {
-            //  .  ..
-            if (wcscmp(findData.cFileName, L".") == 0 || wcscmp(findData.cFileName, L"..") == 0) {
-                continue;
-            }
-            
-            // ·
-            std::wstring fullPath = folderPath + L"\\" + findData.cFileName;
-            
-            if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
-                // ļУݹ鴦
-                ProcessDroppedFolder(fullPath);
-            } else {
-                // ļչ
-                std::wstring extension = PathFindExtension(findData.cFileName);
-                if (_wcsicmp(extension.c_str(), L".wav") == 0 || _wcsicmp(extension.c_str(), L".pcm") == 0) {
-                    // ӵļб
-                    AddFileToList(fullPath);
+    if (!scanner_) {
+        HWND hwnd = hwnd_;
+        scanner_ = std::make_unique<DirectoryScanner>(4, DirectoryScanner::Options(),
+            [hwnd](std::vector<DirectoryScanner::Entry>& batch) {
+                // ÿֻһΣWM_USER + 5Ĵͷ
+                auto* files = new std::vector<DirectoryScanner::Entry>(std::move(batch));
+                if (!PostMessage(hwnd, WM_USER + 5, reinterpret_cast<WPARAM>(files), 0)) {
+                    delete files;
                 }
-            }
-        } while (FindNextFile(hFind, &findData));
-        
-        FindClose(hFind);
+            });
+    }
+    scanner_->Scan(folderPath);
+    if (!is_processing_) {
+        UpdateStatus(L"ɨļ...");
     }
 }
 
 // ļб
 void MainDialog::AddFileToList(const std::wstring& filePath) {
-    // ļǷѾб
-    for (const auto& existingFile : file_list_) {
-        if (_wcsicmp(existingFile.c_str(), filePath.c_str()) == 0) {
-            // ļѴڣ
-            return;
-        }
+    // ȡļС
+    WIN32_FILE_ATTRIBUTE_DATA fileAttr;
+    if (!GetFileAttributesEx(filePath.c_str(), GetFileExInfoStandard, &fileAttr)) {
+        AddFileToList(filePath, UINT64_MAX);
+        return;
+    }
+    ULARGE_INTEGER fileSize;
+    fileSize.HighPart = fileAttr.nFileSizeHigh;
+    fileSize.LowPart = fileAttr.nFileSizeLow;
+    AddFileToList(filePath, fileSize.QuadPart);
+}
+
+// ļбļС֪Ŀ¼ɨʱȡãUINT64_MAXʾδ֪
+void MainDialog::AddFileToList(const std::wstring& filePath, uint64_t fileSize) {
+    // ļбϣѴڣִСдʱ
+    if (!file_list_.Add(filePath)) {
+        return;
     }
-    
-    // ļб
-    file_list_.push_back(filePath);
     
     // бͼ
     LVITEM lvi = { 0 };
@@ -911,22 +854,17 @@ void MainDialog::AddFileToList(const std::wstring& filePath) {
     lvi.pszText = PathFindFileName(filePath.c_str());
     ListView_InsertItem(list_view_, &lvi);
     
-    // ȡļСʽ
-    WIN32_FILE_ATTRIBUTE_DATA fileAttr;
-    if (GetFileAttributesEx(filePath.c_str(), GetFileExInfoStandard, &fileAttr)) {
-        ULARGE_INTEGER fileSize;
-        fileSize.HighPart = fileAttr.nFileSizeHigh;
-        fileSize.LowPart = fileAttr.nFileSizeLow;
-        
+    // ʽļС
+    if (fileSize != UINT64_MAX) {
         WCHAR sizeBuf[32];
-        if (fileSize.QuadPart < 1024) {
-            swprintf_s(sizeBuf, L"%llu B", fileSize.QuadPart);
-        } else if (fileSize.QuadPart < 1024 * 1024) {
-            swprintf_s(sizeBuf, L"%.2f KB", fileSize.QuadPart / 1024.0);
-        } else if (fileSize.QuadPart < 1024 * 1024 * 1024) {
-            swprintf_s(sizeBuf, L"%.2f MB", fileSize.QuadPart / (1024.0 * 1024.0));
+        if (fileSize < 1024) {
+            swprintf_s(sizeBuf, L"%llu B", fileSize);
+        } else if (fileSize < 1024 * 1024) {
+            swprintf_s(sizeBuf, L"%.2f KB", fileSize / 1024.0);
+        } else if (fileSize < 1024 * 1024 * 1024) {
+            swprintf_s(sizeBuf, L"%.2f MB", fileSize / (1024.0 * 1024.0));
         } else {
-            swprintf_s(sizeBuf, L"%.2f GB", fileSize.QuadPart / (1024.0 * 1024.0 * 1024.0));
+            swprintf_s(sizeBuf, L"%.2f GB", fileSize / (1024.0 * 1024.0 * 1024.0));
         }
         
         lvi.iSubItem = 1;
@@ -1009,6 +947,15 @@ void MainDialog::InitializeControls() {
     SendMessage(output_format_combo, CB_ADDSTRING, 0, reinterpret_cast<LPARAM>(L"WAV"));
     SendMessage(output_format_combo, CB_ADDSTRING, 0, (LPARAM)L"PCM");
     SendMessage(output_format_combo, CB_SETCURSEL, 1, 0); // ĬѡPCM
+
+    // ʼʽѡ
+    HWND sample_format_combo = GetDlgItem(hwnd_, IDC_SAMPLE_FORMAT);
+    SendMessage(sample_format_combo, CB_ADDSTRING, 0, (LPARAM)L"Դͬ");
+    SendMessage(sample_format_combo, CB_ADDSTRING, 0, (LPARAM)L"16λ");
+    SendMessage(sample_format_combo, CB_ADDSTRING, 0, (LPARAM)L"24λ");
+    SendMessage(sample_format_combo, CB_ADDSTRING, 0, (LPARAM)L"32λ");
+    SendMessage(sample_format_combo, CB_ADDSTRING, 0, (LPARAM)L"32λ");
+    SendMessage(sample_format_combo, CB_SETCURSEL, 0, 0); // ĬԴͬ
 }
 
 void MainDialog::LoadSettings() {
@@ -1036,6 +983,21 @@ void MainDialog::LoadSettings() {
             SendMessage(output_format_combo, CB_SETCURSEL, value, 0);
         }
         
+        // ʽͨͳ
+        if (RegQueryValueEx(hKey, L"SampleFormat", nullptr, nullptr, (LPBYTE)&value, &size) == ERROR_SUCCESS) {
+            HWND sample_format_combo = GetDlgItem(hwnd_, IDC_SAMPLE_FORMAT);
+            SendMessage(sample_format_combo, CB_SETCURSEL, value, 0);
+        }
+        if (RegQueryValueEx(hKey, L"Dither", nullptr, nullptr, (LPBYTE)&value, &size) == ERROR_SUCCESS) {
+            CheckDlgButton(hwnd_, IDC_DITHER_CHECK, value ? BST_CHECKED : BST_UNCHECKED);
+        }
+        if (RegQueryValueEx(hKey, L"ChannelStats", nullptr, nullptr, (LPBYTE)&value, &size) == ERROR_SUCCESS) {
+            CheckDlgButton(hwnd_, IDC_STATS_CHECK, value ? BST_CHECKED : BST_UNCHECKED);
+        }
+        if (RegQueryValueEx(hKey, L"SkipSilent", nullptr, nullptr, (LPBYTE)&value, &size) == ERROR_SUCCESS) {
+            CheckDlgButton(hwnd_, IDC_SKIP_SILENT_CHECK, value ? BST_CHECKED : BST_UNCHECKED);
+        }
+        
         // ߳
         if (RegQueryValueEx(hKey, L"ThreadCount", nullptr, nullptr, (LPBYTE)&value, &size) == ERROR_SUCCESS) {
             HWND thread_count_combo = GetDlgItem(hwnd_, IDC_THREAD_COUNT);
@@ -1056,6 +1018,13 @@ void MainDialog::LoadSettings() {
             SetDlgItemText(hwnd_, IDC_SUFFIX_EDIT, suffix);
         }
 
+        // ͨ
+        WCHAR channel_map[256];
+        size = sizeof(channel_map);
+        if (RegQueryValueEx(hKey, L"ChannelMap", nullptr, nullptr, (LPBYTE)channel_map, &size) == ERROR_SUCCESS) {
+            SetDlgItemText(hwnd_, IDC_CHANNEL_MAP_EDIT, channel_map);
+        }
+
         RegCloseKey(hKey);
     }
 }
@@ -1079,6 +1048,17 @@ void MainDialog::SaveSettings() {
         HWND output_format_combo = GetDlgItem(hwnd_, IDC_OUTPUT_FORMAT);
         value = SendMessage(output_format_combo, CB_GETCURSEL, 0, 0);
         RegSetValueEx(hKey, L"OutputFormat", 0, REG_DWORD, (LPBYTE)&value, sizeof(DWORD));
+
+        // ʽͨͳ
+        HWND sample_format_combo = GetDlgItem(hwnd_, IDC_SAMPLE_FORMAT);
+        value = SendMessage(sample_format_combo, CB_GETCURSEL, 0, 0);
+        RegSetValueEx(hKey, L"SampleFormat", 0, REG_DWORD, (LPBYTE)&value, sizeof(DWORD));
+        value = IsDlgButtonChecked(hwnd_, IDC_DITHER_CHECK) == BST_CHECKED ? 1 : 0;
+        RegSetValueEx(hKey, L"Dither", 0, REG_DWORD, (LPBYTE)&value, sizeof(DWORD));
+        value = IsDlgButtonChecked(hwnd_, IDC_STATS_CHECK) == BST_CHECKED ? 1 : 0;
+        RegSetValueEx(hKey, L"ChannelStats", 0, REG_DWORD, (LPBYTE)&value, sizeof(DWORD));
+        value = IsDlgButtonChecked(hwnd_, IDC_SKIP_SILENT_CHECK) == BST_CHECKED ? 1 : 0;
+        RegSetValueEx(hKey, L"SkipSilent", 0, REG_DWORD, (LPBYTE)&value, sizeof(DWORD));
         
         // ߳
         value = GetDlgItemInt(hwnd_, IDC_THREAD_COUNT, nullptr, FALSE);
@@ -1089,6 +1069,11 @@ void MainDialog::SaveSettings() {
         GetDlgItemText(hwnd_, IDC_SUFFIX_EDIT, suffix, 256);
         RegSetValueEx(hKey, L"Suffix", 0, REG_SZ, (LPBYTE)suffix, (wcslen(suffix) + 1) * sizeof(WCHAR));
 
+        // ͨ
+        WCHAR channel_map[256];
+        GetDlgItemText(hwnd_, IDC_CHANNEL_MAP_EDIT, channel_map, 256);
+        RegSetValueEx(hKey, L"ChannelMap", 0, REG_SZ, (LPBYTE)channel_map, (wcslen(channel_map) + 1) * sizeof(WCHAR));
+
         RegCloseKey(hKey);
     }
 }
@@ -1102,6 +1087,8 @@ void MainDialog::InitThreadPool(int thread_count) {
     max_threads_ = thread_count > 0 ? thread_count : 1;
     shutdown_threads_ = false;
     active_threads_ = 0;
+    next_worker_index_ = 0;
+    scheduler_.Start(max_threads_);
     
     // ߳
     for (int i = 0; i < max_threads_; i++) {
@@ -1125,8 +1112,8 @@ void MainDialog::ShutdownThreadPool() {
     // ̳߳عر
     shutdown_threads_ = true;
     
-    // ֪ͨеȴ߳
-    task_cv_.notify_all();
+    // ֪ͨеȴ̣߳δ
+    scheduler_.Shutdown();
     
     // ȴ߳̽
     if (!worker_threads_.empty()) {
@@ -1139,8 +1126,4 @@ void MainDialog::ShutdownThreadPool() {
         
         worker_threads_.clear();
     }
-    
-    // 
-    std::queue<FileTask> empty;
-    std::swap(task_queue_, empty);
 }
\ No newline at end of file
@@ -3,15 +3,15 @@
 #include "framework.h"
 #include "resource.h"
 #include "audio_processor.h"
+#include "directory_scanner.h"
+#include "file_list.h"
+#include "file_scheduler.h"
+#include "progress_registry.h"
 #include <vector>
 #include <string>
 #include <memory>
 #include <commctrl.h>
-#include <queue>
-#include <mutex>
 #include <atomic>
-#include <condition_variable>
-#include <map>
 
 class MainDialog {
 public:
@@ -39,10 +39,13 @@ private:
     void ImportFile();
     void SplitChannels();
     void UpdateProgress(int progress);
+    void UpdateFileProgress();
+    void SetFileProgressText(int index, int value);
     void UpdateStatus(const std::wstring& status);
     void InitializeControls();
     void ProcessDroppedFolder(const std::wstring& folderPath);
     void AddFileToList(const std::wstring& filePath);
+    void AddFileToList(const std::wstring& filePath, uint64_t fileSize);
 
     // 设置相关
     void LoadSettings();
@@ -55,8 +58,13 @@ private:
     HWND status_text_;
     HWND suffix_edit_;  // 后缀符号输入框
     std::unique_ptr<AudioProcessor> audio_processor_;
-    std::vector<std::wstring> file_list_;
-    std::map<std::wstring, int> file_progress_; // 存储每个文件的处理进度
+    FileList file_list_; // 导入的文件，下标即文件编号
+    std::vector<std::wstring> batch_files_; // 本次处理的文件，开始处理时从file_list_复制
+    std::unique_ptr<DirectoryScanner> scanner_; // 拖放文件夹的后台扫描
+    ProgressRegistry file_progress_; // 每个文件的处理进度，按列表行号索引
+    std::vector<int> progress_snapshot_; // 定时器取得的进度快照
+    std::vector<int> shown_progress_; // 列表中当前显示的进度，定时器只更新有变化的行
+    uint64_t shown_progress_version_ = 0;
     static MainDialog* instance_;
     
     // 工作线程相关
@@ -65,22 +73,27 @@ private:
     
     // 线程池相关
     struct FileTask {
+        size_t file_id = 0; // 文件在列表中的下标，用于定位列表行和进度槽位
         std::wstring file_path;
         std::wstring output_dir;
         AudioProcessor::AudioFormat format;
         AudioProcessor::OutputFormat output_format;
         std::wstring suffix;
+        AudioProcessor::ChannelMap channel_map;
+        AudioProcessor::SampleFormat sample_format = AudioProcessor::SampleFormat::Source;
+        bool dither = false;
+        AudioProcessor::StatsMode stats_mode = AudioProcessor::StatsMode::Off;
+        bool skip_silent = false;
     };
     
-    std::queue<FileTask> task_queue_;
-    std::mutex task_mutex_;
-    std::mutex progress_mutex_; // 用于保护文件进度映射的互斥锁
-    std::condition_variable task_cv_;
+    FileScheduler<FileTask> scheduler_; // 按文件大小调度、支持任务窃取的任务队列
     std::vector<HANDLE> worker_threads_;
+    std::atomic<int> next_worker_index_; // 为每个工作线程分配队列编号
     std::atomic<int> active_threads_;
     std::atomic<int> completed_files_;
     std::atomic<int> error_files_; // 记录处理失败的文件数量
     std::atomic<int> total_files_;
+    SplitMetricsSummary run_metrics_; // 本次批处理的各阶段统计
     int max_threads_;
     bool shutdown_threads_;
     
@@ -99,9 +112,6 @@ private:
     // 关闭线程池
     void ShutdownThreadPool();
     
-    // 添加任务到队列
-    void AddTask(const FileTask& task);
-    
-    // 获取任务从队列
-    bool GetTask(FileTask& task);
+    // 获取任务，worker_index为工作线程的队列编号
+    bool GetTask(int worker_index, FileTask& task);
 };
\ No newline at end of file
@@ -26,6 +26,11 @@
 #define IDC_THREAD_COUNT               1007
 #define IDC_SUFFIX_EDIT                1008
 #define IDD_SETTINGS_DIALOG             1009
+#define IDC_CHANNEL_MAP_EDIT           1010
+#define IDC_SAMPLE_FORMAT              1011
+#define IDC_DITHER_CHECK               1012
+#define IDC_STATS_CHECK                1013
+#define IDC_SKIP_SILENT_CHECK          1014
 #ifndef IDC_STATIC
 #define IDC_STATIC				-1
 #endif
@@ -0,0 +1,87 @@
+#include "async_writer.h"
+#include "file_io.h"
+#include "split_metrics.h"
+#include <algorithm>
+
+bool AsyncWriter::Batch::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return pending_ == 0; });
+    return !failed_;
+}
+
+AsyncWriter::AsyncWriter(int thread_count) {
+    for (int i = 0; i < (thread_count > 0 ? thread_count : 1); ++i) {
+        threads_.emplace_back(&AsyncWriter::Run, this);
+    }
+}
+
+AsyncWriter::~AsyncWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void AsyncWriter::Write(RandomAccessFile& file, uint64_t offset, const void* data, size_t size, Batch& batch) {
+    {
+        std::lock_guard<std::mutex> lock(batch.mutex_);
+        ++batch.pending_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == requests_.size()) {
+            // 队列已满时按顺序搬到新的环形队列中
+            std::vector<Request> grown((std::max)(size_t(16), requests_.size() * 2));
+            for (size_t i = 0; i < count_; ++i) {
+                grown[i] = requests_[(head_ + i) % requests_.size()];
+            }
+            requests_.swap(grown);
+            head_ = 0;
+        }
+        requests_[(head_ + count_) % requests_.size()] = {&file, offset, data, size, &batch};
+        ++count_;
+    }
+    cv_.notify_one();
+}
+
+void AsyncWriter::Run() {
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || count_ > 0; });
+            // 退出前先处理完已提交的请求，避免等待中的Batch永远无法完成
+            if (count_ == 0) {
+                return;
+            }
+            request = requests_[head_];
+            head_ = (head_ + 1) % requests_.size();
+            --count_;
+        }
+
+        double write_seconds = 0.0;
+        double write_cpu_seconds = 0.0;
+        bool ok;
+        {
+            StageTimer timer(write_seconds, write_cpu_seconds);
+            ok = request.file->WriteAt(request.offset, request.data, request.size);
+        }
+
+        Batch& batch = *request.batch;
+        std::lock_guard<std::mutex> lock(batch.mutex_);
+        batch.write_seconds_ += write_seconds;
+        batch.write_cpu_seconds_ += write_cpu_seconds;
+        if (ok) {
+            batch.bytes_written_ += request.size;
+        } else {
+            batch.failed_ = true;
+        }
+        if (--batch.pending_ == 0) {
+            batch.cv_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class RandomAccessFile;
+
+// 异步写入队列：后台线程按偏移写入输出文件，多个通道的写入同时进行，
+// 调用方在写入期间可以继续分离下一块数据
+class AsyncWriter {
+public:
+    // 一组写入请求，用于等待某个缓冲区的数据全部落盘后再复用
+    class Batch {
+    public:
+        // 等待已提交的写入全部完成，其中任意一个失败时返回false
+        bool Wait();
+
+        // 已完成写入的累计统计，在Wait()返回后读取
+        uint64_t BytesWritten() const { return bytes_written_; }
+        double WriteSeconds() const { return write_seconds_; }
+        double WriteCpuSeconds() const { return write_cpu_seconds_; }
+
+    private:
+        friend class AsyncWriter;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        size_t pending_ = 0;
+        bool failed_ = false;
+        uint64_t bytes_written_ = 0;
+        double write_seconds_ = 0.0;
+        double write_cpu_seconds_ = 0.0;
+    };
+
+    explicit AsyncWriter(int thread_count);
+    ~AsyncWriter();
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    // 提交写入请求，data在batch.Wait()返回前必须保持有效
+    void Write(RandomAccessFile& file, uint64_t offset, const void* data, size_t size, Batch& batch);
+
+    int ThreadCount() const { return static_cast<int>(threads_.size()); }
+
+private:
+    struct Request {
+        RandomAccessFile* file;
+        uint64_t offset;
+        const void* data;
+        size_t size;
+        Batch* batch;
+    };
+
+    void Run();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    // 环形队列，容量只增不减，稳定状态下提交请求不分配内存
+    std::vector<Request> requests_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
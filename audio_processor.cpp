@@ -1,10 +1,135 @@
 #include "audio_processor.h"
+#include "async_writer.h"
+#include "buffer_arena.h"
+#include "channel_stats.h"
+#include "deinterleave.h"
+#include "file_io.h"
+#include "resampler.h"
+#include "riff_reader.h"
+#include "sample_convert.h"
+#include "split_pipeline.h"
+#include "split_metrics.h"
+#include "split_workers.h"
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
 
-AudioProcessor::AudioProcessor() : progress_(0) {
+namespace {
+
+// 后台写入线程数上限，通道数更多时写入请求在队列中排队
+const int kMaxWriterThreads = 16;
+
+// arena_中的缓冲区编号：内存模式的输入数据，之后每个分段占用3个（读取缓冲区和两组通道缓冲区）
+// 重采样不分段，在第一个分段的3个之后另用2个存放每段分离出的源样本和浮点样本
+const size_t kInputSlot = 0;
+const size_t kFirstRangeSlot = 1;
+const size_t kResampleScratchSlot = kFirstRangeSlot + 3;
+const size_t kResampleFloatSlot = kFirstRangeSlot + 4;
+
+// RIFF中32位大小字段的最大值，超过时需使用RF64
+const uint64_t kMaxRiffSize = 0xFFFFFFFF;
+
+// 转换样本格式时每段处理的帧数，各通道的临时数据保持在缓存中
+const size_t kConvertFrames = 1024;
+
+// 统计通道时每段分离的帧数，分离后立即统计同一段源数据，源数据仍在缓存中
+const size_t kStatsFrames = 4096;
+
+// 读取源文件头时ifstream使用的缓冲区大小，缓冲区位于调用方的栈上
+const size_t kInputBufferBytes = 512;
+
+// 输出路径字符串预留的容量（字符数），常见长度的路径在文件之间复用时不再分配
+const size_t kPathReserve = 260;
+
+// 按位深度和fmt块中的格式确定源样本格式，不支持的格式返回false
+bool SourceSampleType(int bits_per_sample, uint16_t sub_format, SampleType& type) {
+    switch (bits_per_sample) {
+        case 8: type = SampleType::UInt8; return true;
+        case 16: type = SampleType::Int16; return true;
+        case 24: type = SampleType::Int24; return true;
+        case 32: type = sub_format == 3 ? SampleType::Float32 : SampleType::Int32; return true;
+        default: return false;
+    }
+}
+
+// 通道映射只有一个输出文件，且按源文件的顺序包含全部通道
+bool IsUnchangedMap(const AudioProcessor::ChannelMap& map, int num_channels) {
+    if (map.size() != 1 || map[0].size() != static_cast<size_t>(num_channels)) {
+        return false;
+    }
+    for (int ch = 0; ch < num_channels; ++ch) {
+        if (map[0][ch] != ch) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 通道映射按顺序为每个通道各输出一个文件
+bool IsFullSplitMap(const AudioProcessor::ChannelMap& map, int num_channels) {
+    if (map.size() != static_cast<size_t>(num_channels)) {
+        return false;
+    }
+    for (int ch = 0; ch < num_channels; ++ch) {
+        if (map[ch].size() != 1 || map[ch][0] != ch) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 将64位大小截断到32位字段能表示的范围，仅用作模板头中的占位值
+uint32_t ClampRiffSize(uint64_t size) {
+    return static_cast<uint32_t>(std::min(size, kMaxRiffSize - sizeof(WAVHeader) + 8));
+}
+
+// 生成标准44字节PCM WAV文件头
+WAVHeader MakeWavHeader(uint16_t num_channels, uint32_t sample_rate, uint16_t bits_per_sample, uint32_t data_size) {
+    WAVHeader header;
+    std::memcpy(header.riff_id, "RIFF", 4);
+    std::memcpy(header.wave_id, "WAVE", 4);
+    std::memcpy(header.fmt_id, "fmt ", 4);
+    std::memcpy(header.data_id, "data", 4);
+
+    header.fmt_size = 16;
+    header.audio_format = 1; // PCM格式
+    header.num_channels = num_channels;
+    header.sample_rate = sample_rate;
+    header.bits_per_sample = bits_per_sample;
+    header.block_align = static_cast<uint16_t>(bits_per_sample / 8 * num_channels);
+    header.byte_rate = sample_rate * header.block_align;
+    header.data_size = data_size;
+    header.file_size = data_size + sizeof(WAVHeader) - 8;
+    return header;
+}
+
+// 打开源文件：文件头只需几次小读取，data块整块读入arena_，ifstream使用调用方提供的buffer，
+// 不为每个文件分配内部缓冲区（无缓冲方式在libstdc++中仍会分配），buffer须比file后销毁
+bool OpenInputFile(const std::wstring& file_path, std::ifstream& file, char* buffer, size_t size) {
+    file.rdbuf()->pubsetbuf(buffer, static_cast<std::streamsize>(size));
+#ifdef _WIN32
+    file.open(file_path.c_str(), std::ios::binary);
+#else
+    file.open(Utf8Path(file_path), std::ios::binary);
+#endif
+    return file.is_open();
+}
+
+} // namespace
+
+AudioProcessor::AudioProcessor()
+    : silence_threshold_db_(-std::numeric_limits<double>::infinity()), progress_(0) {
     wav_header_ = std::make_unique<WAVHeader>();
+    mapped_file_ = std::make_unique<MappedFile>();
+    arena_ = std::make_unique<BufferArena>();
     file_path_.clear();
 }
 
@@ -12,8 +137,12 @@ AudioProcessor::~AudioProcessor() = default;
 
 bool AudioProcessor::LoadWavFile(const std::wstring& file_path) {
     file_path_ = file_path;
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
+    metrics_ = SplitMetrics();
+    StageTimer timer(metrics_.load_seconds, metrics_.load_cpu_seconds);
+
+    char buffer[kInputBufferBytes];
+    std::ifstream file;
+    if (!OpenInputFile(file_path, file, buffer, sizeof(buffer))) {
         return false;
     }
 
@@ -23,44 +152,144 @@ bool AudioProcessor::LoadWavFile(const std::wstring& file_path) {
     file.seekg(0); // 重置文件指针
 
     // 检查是否为WAV格式（RIFF标识）
-    if (std::string(header, 4) == "RIFF") {
-        // 读取WAV文件头
-        file.read(reinterpret_cast<char*>(wav_header_.get()), sizeof(WAVHeader));
-
-        // 验证WAV文件格式
-        if (std::string(wav_header_->riff_id, 4) != "RIFF" ||
-            std::string(wav_header_->wave_id, 4) != "WAVE" ||
-            std::string(wav_header_->fmt_id, 4) != "fmt " ||
-            std::string(wav_header_->data_id, 4) != "data") {
+    std::string riff_id(header, 4);
+    if (riff_id == "RIFF" || riff_id == "RF64" || riff_id == "BW64") {
+        // 逐块查找fmt和data块，允许中间有LIST、JUNK等其他块
+        RiffLayout layout;
+        if (!ReadRiffLayout(file, layout)) {
             return false;
         }
 
         // 更新音频格式
-        audio_format_.sample_rate = wav_header_->sample_rate;
-        audio_format_.bits_per_sample = wav_header_->bits_per_sample;
-        audio_format_.num_channels = wav_header_->num_channels;
+        audio_format_.sample_rate = layout.sample_rate;
+        audio_format_.bits_per_sample = layout.bits_per_sample;
+        audio_format_.num_channels = layout.num_channels;
 
-        // 读取音频数据
-        audio_data_.resize(wav_header_->data_size);
-        file.read(reinterpret_cast<char*>(audio_data_.data()), wav_header_->data_size);
+        source_format_.format_tag = layout.format_tag;
+        source_format_.sub_format = layout.sub_format;
+        source_format_.valid_bits = layout.valid_bits;
+        source_format_.channel_mask = layout.channel_mask;
 
-        return true;
+        // 输出使用标准的16字节fmt块，EXTENSIBLE格式取其子格式
+        *wav_header_ = MakeWavHeader(layout.num_channels, layout.sample_rate, layout.bits_per_sample,
+                                     ClampRiffSize(layout.data_size));
+        wav_header_->audio_format = layout.sub_format;
+        wav_header_->byte_rate = layout.byte_rate;
+        wav_header_->block_align = layout.block_align;
+
+        data_offset_ = layout.data_offset;
+        data_size_ = layout.data_size;
+
+        // 流式和映射模式下只记录data块位置，拆分时再按块读取
+        if (input_mode_ != InputMode::Memory) {
+            return PrepareDeferredInput();
+        }
+        mapped_file_->Close();
+
+        // 读取音频数据
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(data_offset_));
+        return ReadInputData(file);
     } else {
         // 如果不是WAV格式，尝试作为PCM格式加载
-        return LoadPcmFile(file_path);
+        return LoadPcmData(file);
+    }
+
+
+}
+
+bool AudioProcessor::ProbeFile(const std::wstring& file_path, const AudioFormat& pcm_format, ProbeInfo& info) {
+    info = ProbeInfo();
+    std::error_code error;
+    uint64_t file_size = std::filesystem::file_size(std::filesystem::path(file_path), error);
+    if (error) {
+        return false;
     }
+    info.file_size = file_size;
 
+    char header[4] = {};
+    char buffer[kInputBufferBytes];
+    std::ifstream file;
+    if (!OpenInputFile(file_path, file, buffer, sizeof(buffer))) {
+        return false;
+    }
+    file.read(header, 4);
+    file.clear();
+    file.seekg(0);
 
+    std::string riff_id(header, 4);
+    if (riff_id == "RIFF" || riff_id == "RF64" || riff_id == "BW64") {
+        RiffLayout layout;
+        if (!ReadRiffLayout(file, layout)) {
+            return false;
+        }
+        info.is_wav = true;
+        info.format.sample_rate = layout.sample_rate;
+        info.format.bits_per_sample = layout.bits_per_sample;
+        info.format.num_channels = layout.num_channels;
+        info.source_format.format_tag = layout.format_tag;
+        info.source_format.sub_format = layout.sub_format;
+        info.source_format.valid_bits = layout.valid_bits;
+        info.source_format.channel_mask = layout.channel_mask;
+        info.data_offset = layout.data_offset;
+        info.data_size = layout.data_size;
+    } else {
+        // 与LoadPcmData()相同，文件大小必须是块对齐的整数倍
+        info.format = pcm_format;
+        info.data_size = file_size;
+    }
+
+    uint64_t block_align = static_cast<uint64_t>(info.format.bits_per_sample / 8) * info.format.num_channels;
+    if (block_align == 0 || (!info.is_wav && info.data_size % block_align != 0)) {
+        return false;
+    }
+    info.frames = info.data_size / block_align;
+    if (info.format.sample_rate > 0) {
+        info.duration_seconds = static_cast<double>(info.frames) / info.format.sample_rate;
+    }
+    info.valid = true;
+    return true;
+}
+
+std::vector<AudioProcessor::ProbeInfo> AudioProcessor::ProbeFiles(const std::vector<std::wstring>& file_paths,
+                                                                  const AudioFormat& pcm_format, int thread_count) {
+    std::vector<ProbeInfo> results(file_paths.size());
+    // 每个文件只有几次小读取，耗时主要在打开文件和等待磁盘，多线程可以重叠这些等待
+    std::atomic<size_t> next(0);
+    auto worker = [&] {
+        for (size_t i = next++; i < file_paths.size(); i = next++) {
+            ProbeFile(file_paths[i], pcm_format, results[i]);
+        }
+    };
+
+    int count = std::max(1, std::min(thread_count, static_cast<int>(file_paths.size())));
+    std::vector<std::thread> threads;
+    for (int i = 1; i < count; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return results;
 }
 
 bool AudioProcessor::LoadPcmFile(const std::wstring& file_path) {
     file_path_ = file_path;
-    std::ifstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
+    metrics_ = SplitMetrics();
+    StageTimer timer(metrics_.load_seconds, metrics_.load_cpu_seconds);
+
+    char buffer[kInputBufferBytes];
+    std::ifstream file;
+    if (!OpenInputFile(file_path, file, buffer, sizeof(buffer))) {
         return false;
     }
+    return LoadPcmData(file);
+}
 
-    // 获取文件大小
+bool AudioProcessor::LoadPcmData(std::ifstream& file) {
+    // 获取文件大小（文件不足4字节时判断格式的读取会置失败位，先清除）
+    file.clear();
     file.seekg(0, std::ios::end);
     std::streampos file_size = file.tellg();
     file.seekg(0, std::ios::beg);
@@ -73,31 +302,310 @@ bool AudioProcessor::LoadPcmFile(const std::wstring& file_path) {
     }
 
     // 创建WAV头
-    wav_header_ = std::make_unique<WAVHeader>();
-    std::memcpy(wav_header_->riff_id, "RIFF", 4);
-    std::memcpy(wav_header_->wave_id, "WAVE", 4);
-    std::memcpy(wav_header_->fmt_id, "fmt ", 4);
-    std::memcpy(wav_header_->data_id, "data", 4);
-
-    wav_header_->fmt_size = 16;
-    wav_header_->audio_format = 1; // PCM格式
-    wav_header_->num_channels = audio_format_.num_channels;
-    wav_header_->sample_rate = audio_format_.sample_rate;
-    wav_header_->bits_per_sample = audio_format_.bits_per_sample;
-    wav_header_->block_align = block_align;
-    wav_header_->byte_rate = wav_header_->sample_rate * block_align;
-    wav_header_->data_size = static_cast<uint32_t>(file_size);
-    wav_header_->file_size = static_cast<uint32_t>(file_size) + sizeof(WAVHeader) - 8;
+    *wav_header_ = MakeWavHeader(audio_format_.num_channels, audio_format_.sample_rate,
+                                 audio_format_.bits_per_sample, ClampRiffSize(static_cast<uint64_t>(file_size)));
+    source_format_ = SourceFormat();
+
+    data_offset_ = 0;
+    data_size_ = static_cast<uint64_t>(file_size);
+
+    // 流式和映射模式下只记录data块位置，拆分时再按块读取
+    if (input_mode_ != InputMode::Memory) {
+        return PrepareDeferredInput();
+    }
+    mapped_file_->Close();
 
     // 读取PCM数据
-    audio_data_.resize(file_size);
-    file.read(reinterpret_cast<char*>(audio_data_.data()), file_size);
+    return ReadInputData(file);
+}
+
+bool AudioProcessor::ReadInputData(std::ifstream& file) {
+    uint64_t allocations_before = arena_->AllocationCount();
+    uint64_t allocated_before = arena_->AllocatedBytes();
+    audio_data_ = arena_->Acquire(kInputSlot, static_cast<size_t>(data_size_));
+    metrics_.allocation_count += arena_->AllocationCount() - allocations_before;
+    metrics_.allocated_bytes += arena_->AllocatedBytes() - allocated_before;
+
+    file.read(reinterpret_cast<char*>(audio_data_), static_cast<std::streamsize>(data_size_));
+    size_t got = static_cast<size_t>(file.gcount());
+    metrics_.bytes_read += got;
+
+    // 复用的缓冲区中残留上一个文件的数据，文件长度不足data_size时补零
+    if (got < data_size_) {
+        std::memset(audio_data_ + got, 0, static_cast<size_t>(data_size_) - got);
+    }
+    return true;
+}
+
+bool AudioProcessor::SplitChannels(const std::wstring& /*output_dir*/, const std::wstring& suffix) {
+    double start = WallClockSeconds();
+    channel_stats_.clear();
+    silent_outputs_.clear();
+    for (auto& blocks : skipped_blocks_) {
+        blocks.clear();
+    }
+    bool result = RunSplit(suffix);
+
+    // 各块的统计结果按帧顺序合并，拆分成功时按设置写入统计文件
+    if (stats_mode_ != StatsMode::Off || skip_silent_) {
+        stats_collector_.Merge(channel_stats_);
+        if (!result) {
+            channel_stats_.clear();
+        } else {
+            std::wstring stats_path = MakeStatsPath(file_path_, suffix, stats_mode_);
+            if (!stats_path.empty()) {
+                std::string text = stats_mode_ == StatsMode::Json
+                    ? ChannelStatsJson(channel_stats_) + "\n" : ChannelStatsCsv(channel_stats_);
+                std::ofstream file(std::filesystem::path(stats_path), std::ios::binary | std::ios::trunc);
+                file.write(text.data(), static_cast<std::streamsize>(text.size()));
+                result = static_cast<bool>(file.flush());
+                metrics_.bytes_written += text.size();
+                output_paths_.push_back(stats_path);
+            }
+        }
+    }
+    // 保留下来的8位输出在关闭前补写跳过的静音块
+    if (result && skip_silent_) {
+        result = FillSkippedBlocks();
+    }
+    metrics_.split_seconds = WallClockSeconds() - start;
+
+    // 输出文件对象留待下一个文件复用，这里只关闭文件
+    for (auto& output : outputs_) {
+        if (output) {
+            output->Close();
+        }
+    }
+
+    // 整个文件处理完才能确定通道是否静音，静音输出在关闭后删除并列入报告
+    if (result && skip_silent_) {
+        RemoveSilentOutputs();
+    }
+
+    if (metrics_callback_) {
+        metrics_callback_(metrics_);
+    }
+    return result;
+}
+
+bool AudioProcessor::IsSilentOutput(size_t out) const {
+    // 阈值为负无穷时换算为0，只有峰值为零的通道算作静音
+    float threshold = static_cast<float>(std::pow(10.0, silence_threshold_db_ / 20.0));
+    // output_paths_的前output_map_.size()项与通道映射一一对应，之后为统计文件
+    bool silent = out < output_map_.size();
+    for (size_t i = 0; silent && i < output_map_[out].size(); ++i) {
+        int ch = output_map_[out][i];
+        silent = ch >= 0 && ch < static_cast<int>(channel_stats_.size()) &&
+                 channel_stats_[ch].samples > 0 && channel_stats_[ch].peak <= threshold;
+    }
+    return silent;
+}
+
+void AudioProcessor::RemoveSilentOutputs() {
+    std::vector<std::wstring> kept;
+    for (size_t out = 0; out < output_paths_.size(); ++out) {
+        bool silent = IsSilentOutput(out);
+        std::error_code ec;
+        if (silent && std::filesystem::remove(std::filesystem::path(output_paths_[out]), ec)) {
+            silent_outputs_.push_back({output_paths_[out], output_map_[out]});
+        } else {
+            kept.push_back(output_paths_[out]);
+        }
+    }
+    output_paths_ = std::move(kept);
+}
+
+void AudioProcessor::RecycleOutputPaths() {
+    // 移动字符串只转移缓冲区，两个数组的容量也保留，来回移动都不分配内存
+    for (auto& path : output_paths_) {
+        path_pool_.push_back(std::move(path));
+    }
+    output_paths_.clear();
+}
+
+std::wstring& AudioProcessor::AddOutputPath() {
+    if (path_pool_.empty()) {
+        output_paths_.emplace_back();
+        output_paths_.back().reserve(kPathReserve);
+    } else {
+        output_paths_.push_back(std::move(path_pool_.back()));
+        path_pool_.pop_back();
+    }
+    return output_paths_.back();
+}
+
+void AudioProcessor::AddSkippedBlock(int out, uint64_t offset, uint64_t size) {
+    std::lock_guard<std::mutex> lock(skipped_mutex_);
+    auto& blocks = skipped_blocks_[out];
+    for (auto& block : blocks) {
+        if (block.first + block.second == offset) {
+            block.second += size;
+            return;
+        }
+        if (offset + size == block.first) {
+            block.first = offset;
+            block.second += size;
+            return;
+        }
+    }
+    blocks.push_back({offset, size});
+}
+
+bool AudioProcessor::FillSkippedBlocks() {
+    // 静音块通常很少，补写缓冲区只在需要时分配
+    const size_t kFillBytes = 64 * 1024;
+    std::vector<uint8_t> fill;
+    for (size_t out = 0; out < skipped_blocks_.size() && out < outputs_.size(); ++out) {
+        if (skipped_blocks_[out].empty() || IsSilentOutput(out)) {
+            continue;
+        }
+        if (fill.empty()) {
+            fill.assign(kFillBytes, 0x80);
+        }
+        for (const auto& block : skipped_blocks_[out]) {
+            for (uint64_t done = 0; done < block.second; done += kFillBytes) {
+                size_t bytes = static_cast<size_t>(std::min<uint64_t>(kFillBytes, block.second - done));
+                if (!outputs_[out]->WriteAt(block.first + done, fill.data(), bytes)) {
+                    return false;
+                }
+                metrics_.bytes_written += bytes;
+            }
+        }
+    }
+    return true;
+}
+
+std::wstring AudioProcessor::MakeOutputPath(const std::wstring& input_path, int channel,
+                                           const std::wstring& suffix, OutputFormat format) {
+    return MakeOutputPath(input_path, std::vector<int>{channel}, suffix, format);
+}
+
+std::wstring AudioProcessor::MakeOutputPath(const std::wstring& input_path, const std::vector<int>& channels,
+                                           const std::wstring& suffix, OutputFormat format) {
+    std::wstring path;
+    MakeOutputPrefix(input_path, suffix, path);
+    AppendOutputName(path, channels, format);
+    return path;
+}
+
+void AudioProcessor::MakeOutputPrefix(const std::wstring& input_path, const std::wstring& suffix,
+                                      std::wstring& prefix) {
+    // 直接在字符串上查找目录和扩展名，不经过std::filesystem::path，复用prefix的容量
+    // 目录部分保持输入路径中的写法，文件名去掉最后一个扩展名（以点开头的文件名和".."保持不变）
+#ifdef _WIN32
+    size_t separator = input_path.find_last_of(L"\\/");
+#else
+    size_t separator = input_path.find_last_of(L'/');
+#endif
+    size_t name_start = separator == std::wstring::npos ? 0 : separator + 1;
+    size_t name_end = input_path.size();
+    size_t dot = input_path.rfind(L'.');
+    if (dot != std::wstring::npos && dot > name_start && input_path.compare(name_start, std::wstring::npos, L"..") != 0) {
+        name_end = dot;
+    }
+    prefix.assign(input_path, 0, name_end);
+    prefix += suffix;
+}
+
+void AudioProcessor::AppendOutputName(std::wstring& path, const std::vector<int>& channels, OutputFormat format) {
+    for (size_t i = 0; i < channels.size(); ++i) {
+        if (i > 0) {
+            path += L'+';
+        }
+        // 逐位追加通道号，不生成临时字符串
+        wchar_t digits[12];
+        int count = 0;
+        for (unsigned value = static_cast<unsigned>(channels[i] + 1); value > 0 || count == 0; value /= 10) {
+            digits[count++] = static_cast<wchar_t>(L'0' + value % 10);
+        }
+        while (count > 0) {
+            path += digits[--count];
+        }
+    }
+    path += format == OutputFormat::WAV ? L".wav" : L".pcm";
+}
+
+void AudioProcessor::SetChannelMap(const ChannelMap& map) {
+    channel_map_ = map;
+}
+
+const AudioProcessor::ChannelMap& AudioProcessor::GetChannelMap() const {
+    return channel_map_;
+}
+
+bool AudioProcessor::ParseChannelMap(const std::wstring& text, ChannelMap& map) {
+    map.clear();
+    std::wstring compact;
+    for (wchar_t c : text) {
+        if (c != L' ' && c != L'\t') {
+            compact += c;
+        }
+    }
+    if (compact.empty()) {
+        return true;
+    }
+
+    std::vector<int> group;
+    int channel = 0;
+    bool has_digit = false;
+    // 末尾按逗号处理，最后一组与其他组按同样方式结束
+    for (size_t i = 0; i <= compact.size(); ++i) {
+        wchar_t c = i < compact.size() ? compact[i] : L',';
+        if (c >= L'0' && c <= L'9') {
+            channel = channel * 10 + (c - L'0');
+            if (channel > 65535) {
+                map.clear();
+                return false;
+            }
+            has_digit = true;
+            continue;
+        }
+        if ((c != L'+' && c != L',') || !has_digit || channel < 1) {
+            map.clear();
+            return false;
+        }
+        group.push_back(channel - 1);
+        channel = 0;
+        has_digit = false;
+        if (c == L',') {
+            map.push_back(std::move(group));
+            group.clear();
+        }
+    }
+    return true;
+}
 
+bool AudioProcessor::ResolveChannelMap(int num_channels, ChannelMap& map) const {
+    // 逐项赋值而不整体替换，map中各组的容量在文件之间复用
+    if (channel_map_.empty()) {
+        map.resize(num_channels);
+        for (int ch = 0; ch < num_channels; ++ch) {
+            map[ch].assign(1, ch);
+        }
+        return true;
+    }
+    for (const auto& group : channel_map_) {
+        if (group.empty()) {
+            return false;
+        }
+        for (int ch : group) {
+            if (ch < 0 || ch >= num_channels) {
+                return false;
+            }
+        }
+    }
+    map.resize(channel_map_.size());
+    for (size_t out = 0; out < channel_map_.size(); ++out) {
+        map[out].assign(channel_map_[out].begin(), channel_map_[out].end());
+    }
     return true;
 }
 
-bool AudioProcessor::SplitChannels(const std::wstring& output_dir, const std::wstring& suffix) {
-    if (audio_data_.empty() || !wav_header_) {
+bool AudioProcessor::RunSplit(const std::wstring& suffix) {
+    if (!wav_header_) {
+        return false;
+    }
+    if (data_size_ == 0 || (input_mode_ == InputMode::Memory && !audio_data_)) {
         return false;
     }
 
@@ -105,79 +613,750 @@ bool AudioProcessor::SplitChannels(const std::wstring& output_dir, const std::ws
     int num_channels = audio_format_.num_channels;
     int bytes_per_sample = audio_format_.bits_per_sample / 8;
     int block_align = bytes_per_sample * num_channels;
-    int samples_per_channel = audio_data_.size() / block_align;
+    if (block_align <= 0) {
+        return false;
+    }
+    uint64_t samples_per_channel = data_size_ / block_align;
 
-    // 为每个通道创建数据缓冲区，确保每次都是全新的缓冲区
-    std::vector<std::vector<uint8_t>> channel_data(num_channels);
-    for (auto& channel : channel_data) {
-        // 每个通道的数据大小应该是样本数乘以每个样本的字节数
-        channel.clear(); // 确保缓冲区为空
-        channel.reserve(samples_per_channel * bytes_per_sample);
+    RecycleOutputPaths();
+
+    // 按通道映射确定各输出文件包含的通道
+    ChannelMap& map = output_map_;
+    if (!ResolveChannelMap(num_channels, map)) {
+        return false;
     }
+    int output_count = static_cast<int>(map.size());
 
-    // 分离通道数据
-    for (int i = 0; i < samples_per_channel; ++i) {
-        for (int ch = 0; ch < num_channels; ++ch) {
-            // 计算当前样本中该通道数据的起始位置
-            int src_pos = i * block_align + ch * bytes_per_sample;
-            // 只复制该通道的数据
-            for (int b = 0; b < bytes_per_sample; ++b) {
-                channel_data[ch].push_back(audio_data_[src_pos + b]);
+    // 输出采样率与源文件不同时重采样，样本经由浮点处理，输出帧数按采样率比例计算
+    uint32_t output_rate = wav_header_->sample_rate;
+    bool resample = output_sample_rate_ != 0 && output_sample_rate_ != wav_header_->sample_rate;
+    // 滤波器在文件之间保留，采样率不变时不重新设计系数表
+    if (!filter_) {
+        filter_ = std::make_unique<PolyphaseFilter>();
+    }
+    PolyphaseFilter& filter = *filter_;
+    uint64_t output_frames = samples_per_channel;
+    if (resample) {
+        if (!filter.Design(wav_header_->sample_rate, output_sample_rate_)) {
+            return false;
+        }
+        output_rate = output_sample_rate_;
+        output_frames = filter.OutputFrames(samples_per_channel);
+    }
+
+    // 输出样本格式与源格式不同时，在通道分离的同一遍中完成转换
+    SampleType source_type = SampleType::Int16;
+    SampleType output_type = SampleType::Int16;
+    bool convert = false;
+    if (sample_format_ != SampleFormat::Source || resample) {
+        if (!SourceSampleType(audio_format_.bits_per_sample, source_format_.sub_format, source_type)) {
+            return false;
+        }
+        switch (sample_format_) {
+            case SampleFormat::Int16: output_type = SampleType::Int16; break;
+            case SampleFormat::Int24: output_type = SampleType::Int24; break;
+            case SampleFormat::Int32: output_type = SampleType::Int32; break;
+            case SampleFormat::Float32: output_type = SampleType::Float32; break;
+            default: output_type = source_type; break;
+        }
+        convert = output_type != source_type;
+    }
+    int output_bytes_per_sample = convert ? SampleTypeBytes(output_type) : bytes_per_sample;
+
+    // 统计按源样本格式解释数据，不支持的格式不统计
+    SampleType stats_type = SampleType::Int16;
+    bool collect_stats = (stats_mode_ != StatsMode::Off || skip_silent_) &&
+                         SourceSampleType(audio_format_.bits_per_sample, source_format_.sub_format, stats_type);
+    stats_collector_.Reset(collect_stats ? num_channels : 0);
+    int output_bits = convert ? output_bytes_per_sample * 8 : wav_header_->bits_per_sample;
+    uint16_t output_format_tag = convert ? (output_type == SampleType::Float32 ? 3 : 1) : wav_header_->audio_format;
+
+    // 流式模式（或映射失败时）从源文件按块读取，按偏移读取可供多个线程共用
+    RandomAccessFile input;
+    if (input_mode_ != InputMode::Memory && !mapped_file_->IsOpen()) {
+        if (!input.Open(file_path_, RandomAccessFile::Mode::Read)) {
+            return false;
+        }
+    }
+
+    // 创建每个输出文件，写入文件头并预先设置好最终长度
+    // 单个输出文件的数据超过4GB时输出RF64文件头
+    if (outputs_.size() < static_cast<size_t>(output_count)) {
+        outputs_.resize(output_count);
+    }
+    std::vector<std::unique_ptr<RandomAccessFile>>& outputs = outputs_;
+    std::vector<size_t>& frame_bytes = output_frame_bytes_;
+    std::vector<uint64_t>& header_sizes = output_header_sizes_;
+    std::vector<uint8_t>& header = header_buffer_;
+    frame_bytes.assign(output_count, 0);
+    header_sizes.assign(output_count, 0);
+    // 输出路径的目录和文件名前缀对所有输出相同，只拆分一次输入路径
+    MakeOutputPrefix(file_path_, suffix, output_prefix_);
+    for (int out = 0; out < output_count; ++out) {
+        int channels = static_cast<int>(map[out].size());
+        frame_bytes[out] = static_cast<size_t>(output_bytes_per_sample) * channels;
+        uint64_t output_data_size = output_frames * frame_bytes[out];
+        MakeChannelHeader(output_data_size, channels, output_bits, output_format_tag, output_rate, header);
+        header_sizes[out] = header.size();
+
+        std::wstring& output_path = AddOutputPath();
+        output_path.assign(output_prefix_);
+        AppendOutputName(output_path, map[out], output_format_);
+        if (!outputs[out]) {
+            outputs[out] = std::make_unique<RandomAccessFile>();
+        }
+        if (!outputs[out]->Open(output_path, RandomAccessFile::Mode::Create)) {
+            return false;
+        }
+        if (!outputs[out]->WriteAt(0, header.data(), header.size()) ||
+            !outputs[out]->Resize(header_sizes[out] + output_data_size)) {
+            return false;
+        }
+        metrics_.bytes_written += header_sizes[out];
+    }
+
+    if (skipped_blocks_.size() < static_cast<size_t>(output_count)) {
+        skipped_blocks_.resize(output_count);
+    }
+
+    // 重采样的滤波器状态要求各块按顺序处理，不使用流水线和分段线程
+    if (resample) {
+        return RunResample(input, map, header_sizes, frame_bytes, source_type, output_type, filter,
+                           samples_per_channel);
+    }
+
+    // 只有一个输出且通道顺序与源文件相同时（如单通道文件），输出数据与源数据相同，跳过通道分离直接复制
+    if (!convert && !collect_stats && IsUnchangedMap(map, num_channels) &&
+        CopyUnchanged(input, *outputs[0], header_sizes[0], samples_per_channel * block_align)) {
+        return true;
+    }
+
+    // 每个通道各输出一个文件时按位深度和通道数选择SIMD通道分离内核，
+    // 否则逐个输出文件只抽取映射中的通道，未选中的通道不会被复制
+    DeinterleaveKernel kernel = IsFullSplitMap(map, num_channels)
+        ? SelectDeinterleaveKernel(bytes_per_sample, num_channels) : nullptr;
+    bool dither = dither_;
+    auto split_chunk = [&](const uint8_t* src, uint64_t first_frame, size_t frames, uint8_t* const* dst) {
+        if (!convert) {
+            if (kernel) {
+                kernel(src, frames, bytes_per_sample, num_channels, dst);
+                return;
+            }
+            for (int out = 0; out < output_count; ++out) {
+                GatherChannels(src, frames, bytes_per_sample, num_channels,
+                               map[out].data(), static_cast<int>(map[out].size()), dst[out]);
+            }
+            return;
+        }
+
+        // 转换样本格式时分段处理：先把这一段的通道分离（或抽取）到临时缓冲区，
+        // 再逐通道转换并直接写入输出缓冲区，临时数据始终在缓存中，源数据只读取一次
+        // 临时缓冲区按线程保留，分段线程和流水线线程稳定后不再分配
+        thread_local std::vector<uint8_t> scratch;
+        thread_local std::vector<uint8_t*> scratch_ptrs;
+        size_t channel_bytes = kConvertFrames * bytes_per_sample;
+        size_t scratch_channels = kernel ? static_cast<size_t>(num_channels) : 1;
+        if (scratch.size() < channel_bytes * scratch_channels) {
+            scratch.resize(channel_bytes * scratch_channels);
+        }
+        scratch_ptrs.resize(scratch_channels);
+        for (size_t ch = 0; ch < scratch_channels; ++ch) {
+            scratch_ptrs[ch] = scratch.data() + ch * channel_bytes;
+        }
+
+        for (size_t done = 0; done < frames; done += kConvertFrames) {
+            size_t count = std::min(kConvertFrames, frames - done);
+            const uint8_t* part = src + done * block_align;
+            if (kernel) {
+                kernel(part, count, bytes_per_sample, num_channels, scratch_ptrs.data());
+            }
+            for (int out = 0; out < output_count; ++out) {
+                size_t group = map[out].size();
+                for (size_t k = 0; k < group; ++k) {
+                    int ch = map[out][k];
+                    const uint8_t* samples = scratch_ptrs[0];
+                    if (kernel) {
+                        samples = scratch_ptrs[ch];
+                    } else {
+                        GatherChannels(part, count, bytes_per_sample, num_channels, &ch, 1, scratch_ptrs[0]);
+                    }
+                    ConvertSamples(samples, source_type, count,
+                                   dst[out] + (done * group + k) * output_bytes_per_sample,
+                                   group * output_bytes_per_sample, output_type,
+                                   dither, first_frame + done, ch);
+                }
+            }
+        }
+    };
+
+    // 统计时分段处理：每段分离后接着统计同一段源数据，各块的结果按起始帧交给stats_collector_
+    // 每个通道各输出一个文件且不转换时，输出缓冲区就是分离好的源通道，直接在其上统计；
+    // 重新映射、合并通道或转换格式时，统计对源数据另行分离
+    bool stats_from_output = kernel && !convert;
+    // 跳过静音输出时同时检查每段输出是否全为静音字节，整块静音的输出标记为不必写入
+    // 不转换时输出格式即源格式；8位输出的静音为0x80，跳过的块记录下来，拆分结束后在保留的输出中补写
+    bool check_silence = skip_silent_;
+    uint8_t silence = (convert ? output_type : stats_type) == SampleType::UInt8 ? 0x80 : 0;
+    auto split_block = [&](const uint8_t* src, uint64_t first_frame, size_t frames, uint8_t* const* dst,
+                           uint8_t* skip) {
+        if (!collect_stats) {
+            split_chunk(src, first_frame, frames, dst);
+            return;
+        }
+        thread_local std::vector<uint8_t*> chunk_dst;
+        thread_local std::vector<uint8_t> nonzero;
+        thread_local std::vector<ChannelStats> block_stats;
+        chunk_dst.resize(output_count);
+        nonzero.assign(output_count, check_silence ? 0 : 1);
+        block_stats.assign(num_channels, ChannelStats());
+        for (size_t done = 0; done < frames; done += kStatsFrames) {
+            size_t count = std::min(kStatsFrames, frames - done);
+            for (int out = 0; out < output_count; ++out) {
+                chunk_dst[out] = dst[out] + done * frame_bytes[out];
+            }
+            split_chunk(src + done * block_align, first_frame + done, count, chunk_dst.data());
+            if (stats_from_output) {
+                AccumulateSplitStats(chunk_dst.data(), count, num_channels, stats_type, block_stats.data());
+            } else {
+                AccumulateChannelStats(src + done * block_align, count, num_channels, stats_type,
+                                       block_stats.data());
+            }
+            for (int out = 0; out < output_count; ++out) {
+                if (!nonzero[out]) {
+                    nonzero[out] = !IsAllValue(chunk_dst[out], count * frame_bytes[out], silence);
+                }
+            }
+        }
+        for (int out = 0; out < output_count; ++out) {
+            skip[out] = !nonzero[out];
+            if (skip[out] && silence != 0) {
+                AddSkippedBlock(out, header_sizes[out] + first_frame * frame_bytes[out], frames * frame_bytes[out]);
+            }
+        }
+        stats_collector_.Add(first_frame, block_stats.data());
+    };
+
+    // 交给共享流水线时，块大小和缓冲区由流水线决定，本文件的块与其他文件的块交错处理
+    if (pipeline_) {
+        SplitPipeline::Job job;
+        job.read = [this, &input](uint64_t offset, size_t bytes, uint8_t* block) {
+            return ReadBlock(input, offset, bytes, block);
+        };
+        job.needs_read_buffer = input_mode_ != InputMode::Memory;
+        job.split = split_block;
+        job.frame_bytes = static_cast<size_t>(block_align);
+        job.frames = samples_per_channel;
+        for (int out = 0; out < output_count; ++out) {
+            job.outputs.push_back({outputs[out].get(), header_sizes[out], frame_bytes[out]});
+        }
+        job.progress = [this](uint64_t processed, uint64_t total) {
+            ReportProgress(processed, total);
+        };
+        return pipeline_->Split(job, metrics_);
+    }
+
+    // 每块处理的帧数，缓冲区大小对齐到block_align，内存占用与文件长度无关
+    // data块不足一帧时不处理任何块，只生成空的输出文件
+    uint64_t frames_per_block = std::max<uint64_t>(1, stream_buffer_size_ / block_align);
+    frames_per_block = std::max<uint64_t>(1, std::min(frames_per_block, samples_per_channel));
+    uint64_t block_count = (samples_per_channel + frames_per_block - 1) / frames_per_block;
+
+    // 写入线程数与输出文件数相同，所有输出文件的写入可同时进行，线程在多个文件之间复用
+    int writer_threads = std::min(output_count, kMaxWriterThreads);
+    if (!async_writer_ || async_writer_->ThreadCount() != writer_threads) {
+        async_writer_ = std::make_unique<AsyncWriter>(writer_threads);
+    }
+    AsyncWriter& writer = *async_writer_;
+
+    std::mutex progress_mutex;
+    std::condition_variable progress_cv;
+    uint64_t processed = 0;
+    int finished = 0;
+    std::atomic<bool> failed(false);
+
+    // 在调用线程上从arena_取齐全部缓冲区，各分段线程只使用自己的部分
+    // 每个分段的指针表布局：[读取缓冲区, 第一组各输出缓冲区, 第二组各输出缓冲区]
+    int thread_count = static_cast<int>(std::min<uint64_t>(split_threads_, block_count));
+    int range_count = std::max(1, thread_count);
+    size_t output_block_bytes = 0;
+    for (size_t bytes : frame_bytes) {
+        output_block_bytes += static_cast<size_t>(frames_per_block * bytes);
+    }
+    size_t read_block_bytes = input_mode_ == InputMode::Memory ? 0 : static_cast<size_t>(frames_per_block * block_align);
+    size_t range_stride = 1 + 2 * static_cast<size_t>(output_count);
+
+    uint64_t allocations_before = arena_->AllocationCount();
+    uint64_t allocated_before = arena_->AllocatedBytes();
+    uint8_t** range_ptrs = arena_->AcquirePointers(range_count * range_stride);
+    for (int range = 0; range < range_count; ++range) {
+        uint8_t** ptrs = range_ptrs + range * range_stride;
+        size_t slot = kFirstRangeSlot + range * 3;
+        ptrs[0] = read_block_bytes > 0 ? arena_->Acquire(slot, read_block_bytes) : nullptr;
+        for (int set = 0; set < 2; ++set) {
+            uint8_t* base = arena_->Acquire(slot + 1 + set, output_block_bytes);
+            for (int out = 0; out < output_count; ++out) {
+                ptrs[1 + set * output_count + out] = base;
+                base += frames_per_block * frame_bytes[out];
+            }
+        }
+    }
+    metrics_.allocation_count += arena_->AllocationCount() - allocations_before;
+    metrics_.allocated_bytes += arena_->AllocatedBytes() - allocated_before;
+    range_skip_.assign(static_cast<size_t>(range_count) * output_count, 0);
+
+    // 处理[first_block, last_block)范围内的块，各输出数据按偏移写入输出文件
+    // 不同范围写入的文件区域互不重叠，可由多个线程同时执行
+    auto split_range = [&](int range, uint64_t first_block, uint64_t last_block, bool report) {
+        // 两组输出缓冲区交替使用：一组在后台写入时，另一组用于分离下一块
+        struct ChannelBuffers {
+            uint8_t** ptrs;
+            AsyncWriter::Batch batch;
+        };
+        uint8_t** ptrs = range_ptrs + range * range_stride;
+        uint8_t* block = ptrs[0];
+        uint8_t* skip = range_skip_.data() + static_cast<size_t>(range) * output_count;
+        ChannelBuffers buffers[2];
+        buffers[0].ptrs = ptrs + 1;
+        buffers[1].ptrs = ptrs + 1 + output_count;
+        SplitMetrics range_metrics;
+
+        for (uint64_t index = first_block; index < last_block && !failed; ++index) {
+            uint64_t first_frame = index * frames_per_block;
+            uint64_t frames = std::min(frames_per_block, samples_per_channel - first_frame);
+            size_t block_bytes = static_cast<size_t>(frames * block_align);
+
+            // 等待这组缓冲区上一次提交的写入完成后再复用
+            ChannelBuffers& set = buffers[(index - first_block) % 2];
+            {
+                double wait_cpu_seconds = 0.0;
+                StageTimer timer(range_metrics.write_wait_seconds, wait_cpu_seconds);
+                if (!set.batch.Wait()) {
+                    failed = true;
+                    break;
+                }
+            }
+
+            const uint8_t* src;
+            {
+                StageTimer timer(range_metrics.read_seconds, range_metrics.read_cpu_seconds);
+                src = ReadBlock(input, first_frame * block_align, block_bytes, block);
+            }
+            if (input_mode_ != InputMode::Memory) {
+                range_metrics.bytes_read += block_bytes;
+            }
+            {
+                StageTimer timer(range_metrics.deinterleave_seconds, range_metrics.deinterleave_cpu_seconds);
+                std::fill(skip, skip + output_count, 0);
+                split_block(src, first_frame, static_cast<size_t>(frames), set.ptrs, skip);
+            }
+
+            for (int out = 0; out < output_count; ++out) {
+                if (skip[out]) {
+                    continue;
+                }
+                writer.Write(*outputs[out], header_sizes[out] + first_frame * frame_bytes[out],
+                             set.ptrs[out], static_cast<size_t>(frames * frame_bytes[out]), set.batch);
+            }
+
+            if (report) {
+                ReportProgress(first_frame + frames, samples_per_channel);
+            } else {
+                {
+                    std::lock_guard<std::mutex> lock(progress_mutex);
+                    processed += frames;
+                }
+                progress_cv.notify_one();
             }
         }
-        // 每处理1%的数据更新一次进度，避免过于频繁的更新
-        int current_progress = static_cast<int>((i + 1) * 100 / samples_per_channel);
-        if (current_progress != progress_) {
-            progress_ = current_progress;
-            if (progress_callback_) {
-                progress_callback_(progress_);
+
+        for (auto& set : buffers) {
+            double wait_cpu_seconds = 0.0;
+            StageTimer timer(range_metrics.write_wait_seconds, wait_cpu_seconds);
+            if (!set.batch.Wait()) {
+                failed = true;
             }
         }
+
+        for (auto& set : buffers) {
+            range_metrics.bytes_written += set.batch.BytesWritten();
+            range_metrics.write_seconds += set.batch.WriteSeconds();
+            range_metrics.write_cpu_seconds += set.batch.WriteCpuSeconds();
+        }
+
+        std::lock_guard<std::mutex> lock(progress_mutex);
+        metrics_.Add(range_metrics);
+    };
+
+    if (thread_count <= 1) {
+        split_range(0, 0, block_count, true);
+    } else {
+        // 将块均分给各线程，进度由调用线程统一汇报
+        // 线程在文件之间保留，按设置的线程数创建，文件较短时只使用其中一部分
+        if (!split_workers_ || split_workers_->ThreadCount() != split_threads_) {
+            split_workers_ = std::make_unique<SplitWorkers>(split_threads_);
+        }
+        auto range_task = [&](int i) {
+            uint64_t first_block = block_count * i / thread_count;
+            uint64_t last_block = block_count * (i + 1) / thread_count;
+            split_range(i, first_block, last_block, false);
+            {
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                ++finished;
+            }
+            progress_cv.notify_one();
+        };
+        split_workers_->Start(range_task, thread_count);
+
+        std::unique_lock<std::mutex> lock(progress_mutex);
+        uint64_t reported = 0;
+        while (finished < thread_count) {
+            progress_cv.wait(lock, [&] { return processed != reported || finished == thread_count; });
+            reported = processed;
+            lock.unlock();
+            ReportProgress(reported, samples_per_channel);
+            lock.lock();
+        }
+        lock.unlock();
+        split_workers_->Wait();
     }
 
-    // 写入每个通道的WAV文件
-    std::filesystem::path input_path(file_path_);
-    std::wstring stem = input_path.stem().wstring();
-    std::wstring parent_path = input_path.parent_path().wstring();
-    
+    // arena_中的缓冲区在文件之间保留，其总大小即缓冲区占用的峰值
+    metrics_.peak_buffer_bytes = arena_->ReservedBytes();
+
+    return !failed;
+}
+
+bool AudioProcessor::RunResample(RandomAccessFile& input, const ChannelMap& map,
+                                 const std::vector<uint64_t>& header_sizes, const std::vector<size_t>& frame_bytes,
+                                 SampleType source_type, SampleType output_type, const PolyphaseFilter& filter,
+                                 uint64_t samples_per_channel) {
+    int num_channels = audio_format_.num_channels;
+    int bytes_per_sample = audio_format_.bits_per_sample / 8;
+    int block_align = bytes_per_sample * num_channels;
+    int output_count = static_cast<int>(map.size());
+    int output_bytes_per_sample = SampleTypeBytes(output_type);
+    uint8_t silence = output_type == SampleType::UInt8 ? 0x80 : 0;
+
+    // 每个用到的源通道一个重采样器，同一通道出现在多个输出中时只重采样一次
+    // 重采样器和统计结果在文件之间保留，历史缓冲区的容量不再增长
+    std::vector<uint8_t>& used = resample_used_;
+    used.assign(num_channels, 0);
+    for (const auto& group : map) {
+        for (int ch : group) {
+            used[ch] = 1;
+        }
+    }
+    if (resamplers_.size() < static_cast<size_t>(num_channels)) {
+        resamplers_.resize(num_channels);
+    }
+    std::vector<ChannelResampler>& resamplers = resamplers_;
     for (int ch = 0; ch < num_channels; ++ch) {
-        std::wstring output_path = (std::filesystem::path(parent_path) / 
-            (stem + (suffix.empty() ? L"" : suffix) + std::to_wstring(ch + 1) + 
-             (output_format_ == OutputFormat::WAV ? L".wav" : L".pcm"))).wstring();
-        if (!WriteSingleChannelWav(output_path, channel_data[ch], ch)) {
+        resamplers[ch].Reset(&filter);
+    }
+
+    // 各块按顺序处理，统计结果直接累加，结束时作为一整块交给stats_collector_
+    bool collect_stats = stats_mode_ != StatsMode::Off || skip_silent_;
+    std::vector<ChannelStats>& stats = resample_stats_;
+    stats.assign(collect_stats ? num_channels : 0, ChannelStats());
+
+    uint64_t frames_per_block = std::max<uint64_t>(1, stream_buffer_size_ / block_align);
+    frames_per_block = std::max<uint64_t>(1, std::min(frames_per_block, samples_per_channel));
+
+    // 与分段拆分相同的缓冲区布局，一块输入（含结束时补零）产生的输出不超过block_output帧
+    size_t block_output = resamplers[0].MaxOutput(static_cast<size_t>(frames_per_block));
+    size_t output_block_bytes = 0;
+    for (size_t bytes : frame_bytes) {
+        output_block_bytes += block_output * bytes;
+    }
+    size_t read_block_bytes = input_mode_ == InputMode::Memory ? 0 : static_cast<size_t>(frames_per_block * block_align);
+    uint64_t allocations_before = arena_->AllocationCount();
+    uint64_t allocated_before = arena_->AllocatedBytes();
+    // 指针表依次为读取缓冲区、两组输出缓冲区和各源通道的临时缓冲区
+    uint8_t** ptrs = arena_->AcquirePointers(1 + 2 * static_cast<size_t>(output_count) + num_channels);
+    ptrs[0] = read_block_bytes > 0 ? arena_->Acquire(kFirstRangeSlot, read_block_bytes) : nullptr;
+    for (int set = 0; set < 2; ++set) {
+        uint8_t* base = arena_->Acquire(kFirstRangeSlot + 1 + set, output_block_bytes);
+        for (int out = 0; out < output_count; ++out) {
+            ptrs[1 + set * output_count + out] = base;
+            base += block_output * frame_bytes[out];
+        }
+    }
+
+    // 每段的源样本、浮点样本和重采样结果，按通道分开存放，始终位于缓存中
+    size_t slice_output = resamplers[0].MaxOutput(kConvertFrames);
+    size_t scratch_channel_bytes = kConvertFrames * bytes_per_sample;
+    uint8_t* scratch = arena_->Acquire(kResampleScratchSlot, scratch_channel_bytes * num_channels);
+    uint8_t** scratch_ptrs = ptrs + 1 + 2 * output_count;
+    for (int ch = 0; ch < num_channels; ++ch) {
+        scratch_ptrs[ch] = scratch + static_cast<size_t>(ch) * scratch_channel_bytes;
+    }
+    float* samples = reinterpret_cast<float*>(
+        arena_->Acquire(kResampleFloatSlot, (kConvertFrames + slice_output * num_channels) * sizeof(float)));
+    float* resampled = samples + kConvertFrames;
+    metrics_.allocation_count += arena_->AllocationCount() - allocations_before;
+    metrics_.allocated_bytes += arena_->AllocatedBytes() - allocated_before;
+
+    int writer_threads = std::min(output_count, kMaxWriterThreads);
+    if (!async_writer_ || async_writer_->ThreadCount() != writer_threads) {
+        async_writer_ = std::make_unique<AsyncWriter>(writer_threads);
+    }
+    AsyncWriter& writer = *async_writer_;
+    AsyncWriter::Batch batches[2];
+    bool failed = false;
+    uint64_t output_written = 0;    // 已提交写入的输出帧数
+
+    // 把各源通道的重采样结果转换为输出格式，写入输出缓冲区中从第position帧开始的位置
+    auto store = [&](uint8_t* const* dst, size_t position, size_t produced) {
+        for (int out = 0; out < output_count; ++out) {
+            size_t group = map[out].size();
+            for (size_t k = 0; k < group; ++k) {
+                int ch = map[out][k];
+                FloatToSamples(resampled + static_cast<size_t>(ch) * slice_output, produced,
+                               dst[out] + (position * group + k) * output_bytes_per_sample,
+                               group * output_bytes_per_sample, output_type,
+                               dither_, output_written + position, ch);
+            }
+        }
+    };
+
+    DeinterleaveKernel kernel = SelectDeinterleaveKernel(bytes_per_sample, num_channels);
+    uint64_t block_count = (samples_per_channel + frames_per_block - 1) / frames_per_block;
+    for (uint64_t index = 0; index < block_count && !failed; ++index) {
+        uint64_t first_frame = index * frames_per_block;
+        uint64_t frames = std::min(frames_per_block, samples_per_channel - first_frame);
+        size_t block_bytes = static_cast<size_t>(frames * block_align);
+        bool last = index + 1 == block_count;
+
+        AsyncWriter::Batch& batch = batches[index % 2];
+        uint8_t* const* dst = ptrs + 1 + (index % 2) * output_count;
+        {
+            double wait_cpu_seconds = 0.0;
+            StageTimer timer(metrics_.write_wait_seconds, wait_cpu_seconds);
+            if (!batch.Wait()) {
+                failed = true;
+                break;
+            }
+        }
+
+        const uint8_t* src;
+        {
+            StageTimer timer(metrics_.read_seconds, metrics_.read_cpu_seconds);
+            src = ReadBlock(input, first_frame * block_align, block_bytes, ptrs[0]);
+        }
+        if (input_mode_ != InputMode::Memory) {
+            metrics_.bytes_read += block_bytes;
+        }
+
+        size_t position = 0;
+        {
+            StageTimer timer(metrics_.deinterleave_seconds, metrics_.deinterleave_cpu_seconds);
+            for (uint64_t done = 0; done < frames; done += kConvertFrames) {
+                size_t count = static_cast<size_t>(std::min<uint64_t>(kConvertFrames, frames - done));
+                kernel(src + done * block_align, count, bytes_per_sample, num_channels, scratch_ptrs);
+                size_t produced = 0;
+                for (int ch = 0; ch < num_channels; ++ch) {
+                    if (!used[ch] && !collect_stats) {
+                        continue;
+                    }
+                    SamplesToFloat(scratch_ptrs[ch], source_type, count, samples);
+                    if (collect_stats) {
+                        AccumulateFloatStats(samples, count, source_type, stats[ch]);
+                    }
+                    if (used[ch]) {
+                        produced = resamplers[ch].Process(samples, count,
+                                                          resampled + static_cast<size_t>(ch) * slice_output);
+                    }
+                }
+                store(dst, position, produced);
+                position += produced;
+            }
+            // 最后一块之后补零，算出剩余的输出
+            if (last) {
+                size_t produced = 0;
+                for (int ch = 0; ch < num_channels; ++ch) {
+                    if (used[ch]) {
+                        produced = resamplers[ch].Finish(resampled + static_cast<size_t>(ch) * slice_output);
+                    }
+                }
+                store(dst, position, produced);
+                position += produced;
+            }
+        }
+
+        for (int out = 0; out < output_count; ++out) {
+            // 静音的输出块不写入，与分段拆分相同
+            if (skip_silent_ && IsAllValue(dst[out], position * frame_bytes[out], silence)) {
+                if (silence != 0) {
+                    AddSkippedBlock(out, header_sizes[out] + output_written * frame_bytes[out],
+                                    position * frame_bytes[out]);
+                }
+                continue;
+            }
+            writer.Write(*outputs_[out], header_sizes[out] + output_written * frame_bytes[out],
+                         dst[out], position * frame_bytes[out], batch);
+        }
+        output_written += position;
+        ReportProgress(first_frame + frames, samples_per_channel);
+    }
+
+    for (auto& batch : batches) {
+        double wait_cpu_seconds = 0.0;
+        StageTimer timer(metrics_.write_wait_seconds, wait_cpu_seconds);
+        if (!batch.Wait()) {
+            failed = true;
+        }
+        metrics_.bytes_written += batch.BytesWritten();
+        metrics_.write_seconds += batch.WriteSeconds();
+        metrics_.write_cpu_seconds += batch.WriteCpuSeconds();
+    }
+    metrics_.peak_buffer_bytes = arena_->ReservedBytes();
+    if (collect_stats) {
+        stats_collector_.Add(0, stats.data());
+    }
+    return !failed;
+}
+
+bool AudioProcessor::CopyUnchanged(RandomAccessFile& input, RandomAccessFile& output, uint64_t header_size,
+                                   uint64_t data_size) {
+    // 按缓冲区大小分段复制，以便汇报进度
+    uint64_t chunk = std::max<uint64_t>(1, stream_buffer_size_);
+    StageTimer timer(metrics_.write_seconds, metrics_.write_cpu_seconds);
+    uint64_t written = 0;
+
+    // 内存模式下数据已在内存中，直接写出，不再经过通道缓冲区
+    if (input_mode_ == InputMode::Memory) {
+        for (uint64_t offset = 0; offset < data_size; offset += chunk) {
+            size_t bytes = static_cast<size_t>(std::min(chunk, data_size - offset));
+            if (!output.WriteAt(header_size + offset, audio_data_ + offset, bytes)) {
+                return false;
+            }
+            written += bytes;
+            ReportProgress(offset + bytes, data_size);
+        }
+        metrics_.bytes_written += written;
+        return true;
+    }
+
+    // 映射模式下源文件只有映射，另外打开一次用于内核复制
+    if (!input.IsOpen() && !input.Open(file_path_, RandomAccessFile::Mode::Read)) {
+        return false;
+    }
+    for (uint64_t offset = 0; offset < data_size; offset += chunk) {
+        uint64_t bytes = std::min(chunk, data_size - offset);
+        uint64_t copied = 0;
+        if (!output.CopyFrom(input, data_offset_ + offset, header_size + offset, bytes, copied)) {
             return false;
         }
+        written += copied;
+        // 源文件比data_size短时其余部分保持为零，输出文件已预先设置好长度
+        if (copied < bytes) {
+            break;
+        }
+        ReportProgress(offset + bytes, data_size);
     }
+    // 失败时调用方会重新拆分，统计只在成功后累加
+    metrics_.bytes_read += written;
+    metrics_.bytes_written += written;
+    ReportProgress(data_size, data_size);
+    return true;
+}
+
+bool AudioProcessor::PrepareDeferredInput() {
+    audio_data_ = nullptr;
+    mapped_file_->Close();
 
+    // 映射失败时（如32位进程映射超大文件）回退到流式读取
+    if (input_mode_ == InputMode::Mapped && mapped_file_->Open(file_path_)) {
+        mapped_file_->AdviseSequential(data_offset_, data_size_);
+    }
     return true;
 }
 
-bool AudioProcessor::WriteSingleChannelWav(const std::wstring& file_path,
-                                          const std::vector<uint8_t>& channel_data,
-                                          int channel_index) {
-    std::ofstream file(file_path, std::ios::binary);
-    if (!file.is_open()) {
-        return false;
+const uint8_t* AudioProcessor::ReadBlock(RandomAccessFile& input, uint64_t offset, size_t bytes,
+                                         uint8_t* block) const {
+    if (input_mode_ == InputMode::Memory) {
+        return audio_data_ + offset;
     }
 
-    if (output_format_ == OutputFormat::WAV) {
-        // 创建单通道WAV文件头
-        WAVHeader single_channel_header = *wav_header_;
-        single_channel_header.num_channels = 1;
-        // 正确计算单通道的block_align和byte_rate
-        single_channel_header.block_align = single_channel_header.bits_per_sample / 8 * single_channel_header.num_channels; // 确保block_align正确反映单通道
-        single_channel_header.byte_rate = single_channel_header.sample_rate * single_channel_header.block_align;
-        single_channel_header.data_size = static_cast<uint32_t>(channel_data.size());
-        single_channel_header.file_size = single_channel_header.data_size + sizeof(WAVHeader) - 8;
+    uint64_t begin = data_offset_ + offset;
+    size_t got = 0;
+    if (mapped_file_->IsOpen()) {
+        uint64_t available = mapped_file_->Size() > begin ? mapped_file_->Size() - begin : 0;
+        // 直接从映射的data块中取数据，不经过中间拷贝
+        if (available >= bytes) {
+            return mapped_file_->Data() + begin;
+        }
+        got = static_cast<size_t>(available);
+        if (got > 0) {
+            std::memcpy(block, mapped_file_->Data() + begin, got);
+        }
+    } else {
+        got = input.ReadAt(begin, block, bytes);
+    }
 
-        // 写入文件头
-        file.write(reinterpret_cast<const char*>(&single_channel_header), sizeof(WAVHeader));
+    // 文件实际长度不足data_size时补零，与整块读入时的结果保持一致
+    if (got < bytes) {
+        std::memset(block + got, 0, bytes - got);
     }
+    return block;
+}
 
-    // 写入音频数据
-    file.write(reinterpret_cast<const char*>(channel_data.data()), channel_data.size());
+void AudioProcessor::MakeChannelHeader(uint64_t data_size, int num_channels, int bits_per_sample, uint16_t format_tag,
+                                       uint32_t sample_rate, std::vector<uint8_t>& header) const {
+    header.clear();
+    if (output_format_ != OutputFormat::WAV) {
+        return;
+    }
 
-    return true;
+    // 创建输出文件的WAV文件头
+    WAVHeader channel_header = *wav_header_;
+    channel_header.num_channels = static_cast<uint16_t>(num_channels);
+    channel_header.bits_per_sample = static_cast<uint16_t>(bits_per_sample);
+    channel_header.audio_format = format_tag;
+    channel_header.sample_rate = sample_rate;
+    // 按输出的通道数计算block_align和byte_rate
+    channel_header.block_align = channel_header.bits_per_sample / 8 * channel_header.num_channels;
+    channel_header.byte_rate = channel_header.sample_rate * channel_header.block_align;
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&channel_header);
+    if (data_size + sizeof(WAVHeader) - 8 <= kMaxRiffSize) {
+        channel_header.data_size = static_cast<uint32_t>(data_size);
+        channel_header.file_size = channel_header.data_size + sizeof(WAVHeader) - 8;
+        header.assign(bytes, bytes + sizeof(WAVHeader));
+        return;
+    }
+
+    // 超过4GB时写为RF64：RIFF和data块大小置为0xFFFFFFFF，实际大小记录在紧随WAVE之后的ds64块中
+    const size_t riff_size = 12;    // "RF64" + size + "WAVE"
+    const size_t ds64_size = 36;    // "ds64" + size + riffSize(8) + dataSize(8) + sampleCount(8) + tableLength(4)
+    std::memcpy(channel_header.riff_id, "RF64", 4);
+    channel_header.file_size = kMaxRiffSize;
+    channel_header.data_size = kMaxRiffSize;
+
+    uint8_t ds64[ds64_size] = {};
+    uint32_t ds64_chunk_size = ds64_size - 8;
+    uint64_t rf64_riff_size = sizeof(WAVHeader) + ds64_size + data_size - 8;
+    uint64_t sample_count = data_size / channel_header.block_align;
+    std::memcpy(ds64, "ds64", 4);
+    std::memcpy(ds64 + 4, &ds64_chunk_size, 4);
+    std::memcpy(ds64 + 8, &rf64_riff_size, 8);
+    std::memcpy(ds64 + 16, &data_size, 8);
+    std::memcpy(ds64 + 24, &sample_count, 8);
+
+    header.assign(bytes, bytes + riff_size);
+    header.insert(header.end(), ds64, ds64 + ds64_size);
+    header.insert(header.end(), bytes + riff_size, bytes + sizeof(WAVHeader));
+}
+
+void AudioProcessor::ReportProgress(uint64_t processed, uint64_t total) {
+    // 每处理1%的数据更新一次进度，避免过于频繁的更新
+    int current_progress = total > 0 ? static_cast<int>(processed * 100 / total) : 100;
+    if (current_progress != progress_) {
+        progress_ = current_progress;
+        if (progress_callback_) {
+            progress_callback_(progress_);
+        }
+    }
 }
 
 void AudioProcessor::SetAudioFormat(const AudioFormat& format) {
@@ -198,4 +1377,143 @@ void AudioProcessor::SetOutputFormat(OutputFormat format) {
 
 AudioProcessor::OutputFormat AudioProcessor::GetOutputFormat() const {
     return output_format_;
+}
+
+void AudioProcessor::SetInputMode(InputMode mode) {
+    input_mode_ = mode;
+}
+
+AudioProcessor::InputMode AudioProcessor::GetInputMode() const {
+    return input_mode_;
+}
+
+void AudioProcessor::SetStreamBufferSize(size_t bytes) {
+    stream_buffer_size_ = bytes > 0 ? bytes : 1;
+}
+
+const AudioProcessor::SourceFormat& AudioProcessor::GetSourceFormat() const {
+    return source_format_;
+}
+
+uint64_t AudioProcessor::GetDataOffset() const {
+    return data_offset_;
+}
+
+uint64_t AudioProcessor::GetDataSize() const {
+    return data_size_;
+}
+
+const SplitMetrics& AudioProcessor::GetLastMetrics() const {
+    return metrics_;
+}
+
+void AudioProcessor::SetStatsMode(StatsMode mode) {
+    stats_mode_ = mode;
+}
+
+AudioProcessor::StatsMode AudioProcessor::GetStatsMode() const {
+    return stats_mode_;
+}
+
+const std::vector<ChannelStats>& AudioProcessor::GetLastChannelStats() const {
+    return channel_stats_;
+}
+
+void AudioProcessor::SetSkipSilentOutputs(bool enabled) {
+    skip_silent_ = enabled;
+}
+
+bool AudioProcessor::GetSkipSilentOutputs() const {
+    return skip_silent_;
+}
+
+void AudioProcessor::SetSilenceThreshold(double dbfs) {
+    silence_threshold_db_ = dbfs;
+}
+
+double AudioProcessor::GetSilenceThreshold() const {
+    return silence_threshold_db_;
+}
+
+const std::vector<AudioProcessor::SilentOutput>& AudioProcessor::GetSilentOutputs() const {
+    return silent_outputs_;
+}
+
+std::wstring AudioProcessor::MakeStatsPath(const std::wstring& input_path, const std::wstring& suffix,
+                                           StatsMode mode) {
+    if (mode != StatsMode::Json && mode != StatsMode::Csv) {
+        return std::wstring();
+    }
+    std::filesystem::path path(input_path);
+    std::wstring name = path.stem().wstring() + suffix + (mode == StatsMode::Json ? L".stats.json" : L".stats.csv");
+    return (path.parent_path() / name).wstring();
+}
+
+const std::vector<std::wstring>& AudioProcessor::GetOutputPaths() const {
+    return output_paths_;
+}
+
+std::string AudioProcessor::MakeSettingsKey(const std::wstring& suffix) const {
+    std::string key = "fmt=" + std::to_string(audio_format_.sample_rate) + "/" +
+                      std::to_string(audio_format_.bits_per_sample) + "/" +
+                      std::to_string(audio_format_.num_channels);
+    key += output_format_ == OutputFormat::WAV ? ";out=wav" : ";out=pcm";
+    key += ";suffix=" + std::filesystem::path(suffix).u8string();
+    key += ";map=";
+    for (size_t out = 0; out < channel_map_.size(); ++out) {
+        for (size_t i = 0; i < channel_map_[out].size(); ++i) {
+            key += (i > 0 ? "+" : (out > 0 ? "," : "")) + std::to_string(channel_map_[out][i] + 1);
+        }
+    }
+    key += ";sample=" + std::to_string(static_cast<int>(sample_format_));
+    key += dither_ ? ";dither=1" : ";dither=0";
+    key += ";rate=" + std::to_string(output_sample_rate_);
+    key += ";stats=" + std::to_string(static_cast<int>(stats_mode_));
+    if (skip_silent_) {
+        char threshold[32];
+        std::snprintf(threshold, sizeof(threshold), "%.2f", silence_threshold_db_);
+        key += ";silent=" + std::string(threshold);
+    }
+    return key;
+}
+
+void AudioProcessor::ReleaseBuffers() {
+    audio_data_ = nullptr;
+    arena_->Release();
+}
+
+void AudioProcessor::SetSplitThreads(int count) {
+    split_threads_ = count > 0 ? count : 1;
+}
+
+int AudioProcessor::GetSplitThreads() const {
+    return split_threads_;
+}
+
+void AudioProcessor::SetSampleFormat(SampleFormat format) {
+    sample_format_ = format;
+}
+
+AudioProcessor::SampleFormat AudioProcessor::GetSampleFormat() const {
+    return sample_format_;
+}
+
+void AudioProcessor::SetDither(bool enabled) {
+    dither_ = enabled;
+}
+
+bool AudioProcessor::GetDither() const {
+    return dither_;
+}
+
+void AudioProcessor::SetOutputSampleRate(uint32_t sample_rate) {
+    output_sample_rate_ = sample_rate;
+}
+
+uint32_t AudioProcessor::GetOutputSampleRate() const {
+    return output_sample_rate_;
+}
+
+void AudioProcessor::SetPipeline(std::shared_ptr<SplitPipeline> pipeline) {
+    pipeline_ = std::move(pipeline);
 }
\ No newline at end of file
@@ -5,6 +5,11 @@
 #include <memory>
 #include <cstdint>
 #include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <utility>
+#include "channel_stats.h"
+#include "split_metrics.h"
 
 // WAV文件头结构
 struct WAVHeader {
@@ -28,6 +33,16 @@ struct WAVHeader {
     uint32_t data_size;     // 音频数据大小
 };
 
+class MappedFile;
+class RandomAccessFile;
+class AsyncWriter;
+class SplitWorkers;
+class BufferArena;
+class SplitPipeline;
+class PolyphaseFilter;
+class ChannelResampler;
+enum class SampleType;
+
 class AudioProcessor {
 public:
     // 音频格式设置
@@ -46,12 +61,46 @@ public:
     // 加载PCM文件
     bool LoadPcmFile(const std::wstring& file_path);
     
-    // 拆分通道
+    // 拆分通道，输出文件写在输入文件所在目录，output_dir保留在接口中但不使用
     bool SplitChannels(const std::wstring& output_dir, const std::wstring& suffix = L"");
     
     // 获取和设置音频格式
     void SetAudioFormat(const AudioFormat& format);
     AudioFormat GetAudioFormat() const;
+
+    // 源文件fmt块中的格式信息（PCM输入时为默认值）
+    struct SourceFormat {
+        uint16_t format_tag = 1;        // fmt块中的格式标签，0xFFFE表示EXTENSIBLE
+        uint16_t sub_format = 1;        // 实际样本格式：1 = PCM，3 = IEEE float
+        uint16_t valid_bits = 0;        // 有效位数，0表示与采样位数相同
+        uint32_t channel_mask = 0;      // 声道掩码，仅EXTENSIBLE格式有效
+    };
+    const SourceFormat& GetSourceFormat() const;
+
+    // 最近加载的文件中data块的偏移和大小，可直接定位或映射到音频数据
+    uint64_t GetDataOffset() const;
+    uint64_t GetDataSize() const;
+
+    // 只解析文件头得到的文件信息，不读取音频数据
+    struct ProbeInfo {
+        bool valid = false;             // 文件能打开且格式有效
+        bool is_wav = false;            // RIFF/RF64/BW64文件，否则按PCM格式计算
+        AudioFormat format;             // WAV取自fmt块，PCM为探测时传入的格式
+        SourceFormat source_format;
+        uint64_t file_size = 0;
+        uint64_t data_offset = 0;       // data块在文件中的偏移，PCM为0
+        uint64_t data_size = 0;         // data块大小，PCM为文件大小
+        uint64_t frames = 0;            // 每个通道的样本数
+        double duration_seconds = 0.0;
+    };
+
+    // 探测单个文件：WAV只读取到fmt和data块的块头，PCM只取文件大小并按pcm_format计算帧数
+    // 格式与LoadWavFile()的判断一致，文件无法打开或格式无效时返回false
+    static bool ProbeFile(const std::wstring& file_path, const AudioFormat& pcm_format, ProbeInfo& info);
+
+    // 用thread_count个线程并行探测多个文件，结果与file_paths按下标一一对应
+    static std::vector<ProbeInfo> ProbeFiles(const std::vector<std::wstring>& file_paths,
+                                             const AudioFormat& pcm_format, int thread_count);
     
     // 输出格式枚举
     enum class OutputFormat {
@@ -64,6 +113,111 @@ public:
     
     // 获取输出格式
     OutputFormat GetOutputFormat() const;
+
+    // 输出样本格式，Source表示与源文件相同
+    enum class SampleFormat {
+        Source,
+        Int16,
+        Int24,
+        Int32,
+        Float32
+    };
+
+    // 设置输出样本格式，与源格式不同时在通道分离的同一遍中转换，不需要再次读取数据
+    void SetSampleFormat(SampleFormat format);
+    SampleFormat GetSampleFormat() const;
+
+    // 设置降低精度（如24位转16位、浮点转整数）时是否加入TPDF抖动
+    void SetDither(bool enabled);
+    bool GetDither() const;
+
+    // 设置输出采样率，0或与源文件相同时不重采样
+    // 不同时在通道分离的同一遍中对每个输出通道做多相FIR重采样，各块按顺序处理，块边界处连续
+    void SetOutputSampleRate(uint32_t sample_rate);
+    uint32_t GetOutputSampleRate() const;
+
+    // 通道统计方式：开启时在通道分离的同一遍中统计每个源通道的峰值、RMS、直流偏移、
+    // 满幅样本数和最长零样本段，统计的是转换和重采样之前的源样本
+    enum class StatsMode {
+        Off,
+        Api,    // 只通过GetLastChannelStats()返回
+        Json,   // 同时在输入文件旁写入“名称.stats.json”
+        Csv     // 同时写入“名称.stats.csv”
+    };
+
+    void SetStatsMode(StatsMode mode);
+    StatsMode GetStatsMode() const;
+
+    // 最近一次成功拆分的各源通道统计结果，未开启统计和静音检测时为空
+    const std::vector<ChannelStats>& GetLastChannelStats() const;
+
+    // 开启后，所含源通道的峰值都不超过静音阈值的输出不保留文件，改为在GetSilentOutputs()中列出
+    // 拆分期间数字静音的输出块不写入（输出文件预先扩展到最终大小，未写入的部分即为零），
+    // 数字静音的输出因此只写入文件头，拆分结束后删除；8位输出的静音为0x80，
+    // 跳过的块在保留下来的输出中于拆分结束后补写
+    void SetSkipSilentOutputs(bool enabled);
+    bool GetSkipSilentOutputs() const;
+
+    // 静音阈值（dBFS），默认为负无穷，即只有全为零的数字静音才算静音
+    void SetSilenceThreshold(double dbfs);
+    double GetSilenceThreshold() const;
+
+    // 被判定为静音、未保留文件的输出
+    struct SilentOutput {
+        std::wstring path;
+        std::vector<int> channels;  // 输出包含的源通道（从0开始）
+    };
+
+    // 最近一次成功拆分中被跳过的静音输出
+    const std::vector<SilentOutput>& GetSilentOutputs() const;
+
+    // 统计结果文件的路径，与输出文件位于同一目录，mode为Off或Api时返回空
+    static std::wstring MakeStatsPath(const std::wstring& input_path, const std::wstring& suffix, StatsMode mode);
+
+    // 第channel个通道（从0开始）的输出文件路径，输出文件与输入文件位于同一目录
+    static std::wstring MakeOutputPath(const std::wstring& input_path, int channel,
+                                       const std::wstring& suffix, OutputFormat format);
+
+    // 包含多个通道的输出文件路径，文件名中的通道号以“+”连接，如“take_1+2.wav”
+    static std::wstring MakeOutputPath(const std::wstring& input_path, const std::vector<int>& channels,
+                                       const std::wstring& suffix, OutputFormat format);
+
+    // 输出通道映射：每个元素对应一个输出文件，内容为依次交织写入该文件的源通道（从0开始）
+    // 为空时每个通道各输出一个文件；未出现在映射中的通道不会被复制或写入
+    using ChannelMap = std::vector<std::vector<int>>;
+
+    // 设置和获取输出通道映射，映射中的通道超出文件的通道数时拆分失败
+    void SetChannelMap(const ChannelMap& map);
+    const ChannelMap& GetChannelMap() const;
+
+    // 解析通道映射文本：逗号分隔各输出文件，“+”连接同一文件中的通道，通道从1开始编号
+    // 例如“1,3”只输出第1和第3通道，“1+2,3”把第1、2通道输出为一个双通道文件、第3通道单独输出
+    // 空文本表示全部通道各自输出，格式错误时返回false
+    static bool ParseChannelMap(const std::wstring& text, ChannelMap& map);
+
+    // 输入模式枚举
+    enum class InputMode {
+        Memory,     // 加载时将整个data块读入内存
+        Stream,     // 加载时只解析文件头，拆分时按块流式读取
+        Mapped      // 内存映射源文件，拆分时直接从映射的data块读取，映射失败时回退到流式读取
+    };
+
+    // 设置输入模式
+    void SetInputMode(InputMode mode);
+
+    // 获取输入模式
+    InputMode GetInputMode() const;
+
+    // 设置每次处理的缓冲区大小（字节），实际大小会向下对齐到block_align
+    void SetStreamBufferSize(size_t bytes);
+
+    // 设置单个文件拆分时使用的线程数，大于1时data块按帧对齐分段并行处理，各段按偏移写入输出文件
+    void SetSplitThreads(int count);
+    int GetSplitThreads() const;
+
+    // 设置跨文件共享的读取/分离/写入流水线，设置后拆分的数据块交给流水线处理，
+    // 不再使用本对象的分段线程和写入线程；传入空指针恢复逐文件处理
+    void SetPipeline(std::shared_ptr<SplitPipeline> pipeline);
     
     // 进度回调函数类型定义
     using ProgressCallback = std::function<void(int)>;
@@ -76,17 +230,130 @@ public:
     // 获取处理进度（0-100）
     int GetProgress() const;
 
+    // 最近一个文件的处理统计，加载时清零，拆分结束时更新
+    const SplitMetrics& GetLastMetrics() const;
+
+    // 最近一次拆分创建的输出文件路径，拆分失败时可能只包含部分输出
+    const std::vector<std::wstring>& GetOutputPaths() const;
+
+    // 由当前的音频格式、输出格式、通道映射、样本格式、抖动、输出采样率和后缀生成的文本，
+    // 两次拆分的文本相同时输出内容相同，用于判断已有的输出是否可以沿用
+    std::string MakeSettingsKey(const std::wstring& suffix) const;
+
+    // 释放跨文件复用的缓冲区（如批处理结束后），下一个文件会重新分配
+    void ReleaseBuffers();
+
+    // 统计回调函数类型定义，每次拆分结束（无论成功与否）时调用
+    using MetricsCallback = std::function<void(const SplitMetrics&)>;
+
+    // 设置统计回调函数
+    void SetMetricsCallback(MetricsCallback callback) {
+        metrics_callback_ = callback;
+    }
+
 private:
     OutputFormat output_format_ = OutputFormat::WAV;
+    InputMode input_mode_ = InputMode::Memory;
+    size_t stream_buffer_size_ = 4 * 1024 * 1024;
+    int split_threads_ = 1;
+    ChannelMap channel_map_;
+    SampleFormat sample_format_ = SampleFormat::Source;
+    bool dither_ = false;
+    uint32_t output_sample_rate_ = 0;
+    StatsMode stats_mode_ = StatsMode::Off;
+    ChannelStatsCollector stats_collector_;     // 拆分期间各块的统计结果
+    std::vector<ChannelStats> channel_stats_;
+    bool skip_silent_ = false;
+    double silence_threshold_db_;
+    std::vector<SilentOutput> silent_outputs_;
+    // 8位输出中未写入的静音块（文件偏移, 字节数），保留的输出要补写0x80
+    std::vector<std::vector<std::pair<uint64_t, uint64_t>>> skipped_blocks_;
+    std::mutex skipped_mutex_;
+    ChannelMap output_map_;     // 最近一次拆分的各输出包含的源通道，与output_paths_的前几项对应
     std::unique_ptr<WAVHeader> wav_header_;
-    std::vector<uint8_t> audio_data_;
+    std::unique_ptr<MappedFile> mapped_file_;
+    std::unique_ptr<AsyncWriter> async_writer_;  // 输出文件的后台写入线程
+    std::unique_ptr<SplitWorkers> split_workers_;  // 分段拆分的常驻线程
+    std::unique_ptr<BufferArena> arena_;         // 跨文件复用的输入和通道缓冲区
+    std::unique_ptr<PolyphaseFilter> filter_;    // 重采样滤波器，采样率不变时跨文件复用
+    std::vector<ChannelResampler> resamplers_;   // 各源通道的重采样状态，跨文件复用
+    std::vector<uint8_t> resample_used_;         // 重采样时各源通道是否出现在输出中
+    std::vector<ChannelStats> resample_stats_;   // 重采样时按顺序累加的通道统计
+    std::shared_ptr<SplitPipeline> pipeline_;    // 多个AudioProcessor共享的流水线
+    std::vector<std::unique_ptr<RandomAccessFile>> outputs_;  // 跨文件复用的输出文件对象
+    uint8_t* audio_data_ = nullptr;  // 内存模式下读入的data块，位于arena_中
+    uint64_t data_offset_ = 0;  // data块在源文件中的偏移
+    uint64_t data_size_ = 0;    // data块大小
     AudioFormat audio_format_;
+    SourceFormat source_format_;
     int progress_;
     std::wstring file_path_;
+    std::vector<std::wstring> output_paths_;
+    // 以下对象在文件之间复用，稳定状态下拆分同格式的文件不分配内存
+    std::vector<std::wstring> path_pool_;       // 上一个文件的输出路径字符串，保留容量供下一个文件使用
+    std::wstring output_prefix_;                // 输出路径中各输出共用的部分
+    std::vector<size_t> output_frame_bytes_;    // 各输出文件每帧的字节数
+    std::vector<uint64_t> output_header_sizes_; // 各输出文件的文件头大小
+    std::vector<uint8_t> header_buffer_;        // 生成输出文件头的缓冲区
+    std::vector<uint8_t> range_skip_;           // 各分段中每个输出这一块是否不必写入
     ProgressCallback progress_callback_;
+    SplitMetrics metrics_;
+    MetricsCallback metrics_callback_;
+
+    // 从已打开的文件加载PCM数据，文件头由当前音频格式生成
+    bool LoadPcmData(std::ifstream& file);
+
+    // 内存模式下从file当前位置读入data块
+    bool ReadInputData(std::ifstream& file);
+
+    // 拆分通道的实际实现，SplitChannels在其外层统计耗时并回调
+    bool RunSplit(const std::wstring& suffix);
+
+    // 按通道映射得到本文件的输出通道，未设置映射时每个通道各占一个输出；映射中的通道超出范围时返回false
+    bool ResolveChannelMap(int num_channels, ChannelMap& map) const;
+
+    // 输出路径中各输出共用的部分（目录/输入文件名+后缀）写入prefix，AppendOutputName在其后加上通道号和扩展名
+    static void MakeOutputPrefix(const std::wstring& input_path, const std::wstring& suffix, std::wstring& prefix);
+    static void AppendOutputName(std::wstring& path, const std::vector<int>& channels, OutputFormat format);
+
+    // 输出所含源通道的峰值是否都不超过静音阈值
+    bool IsSilentOutput(size_t out) const;
+
+    // 把output_paths_中的字符串移回path_pool_；AddOutputPath从中取出一个加到output_paths_末尾
+    void RecycleOutputPaths();
+    std::wstring& AddOutputPath();
+
+    // 删除峰值不超过静音阈值的输出文件，移入silent_outputs_
+    void RemoveSilentOutputs();
+
+    // 记录第out个输出中未写入的静音块，与上一段相接时合并；分段线程和流水线线程可同时调用
+    void AddSkippedBlock(int out, uint64_t offset, uint64_t size);
+
+    // 在不是静音的输出中补写跳过的块，静音字节不为零的8位输出才有记录
+    bool FillSkippedBlocks();
+
+    // 输出数据与源数据相同（如单通道文件）时直接把data块复制到输出文件的文件头之后，
+    // 流式/映射模式下由内核复制，不经过用户空间
+    // 系统不支持内核复制或复制失败时返回false，由调用方按常规方式拆分
+    bool CopyUnchanged(RandomAccessFile& input, RandomAccessFile& output, uint64_t header_size, uint64_t data_size);
+
+    // 重采样时的拆分：按顺序逐块读取，每个源通道的重采样器跨块保留状态，
+    // 输出从header_sizes处开始按frame_bytes连续写入
+    bool RunResample(RandomAccessFile& input, const ChannelMap& map, const std::vector<uint64_t>& header_sizes,
+                     const std::vector<size_t>& frame_bytes, SampleType source_type, SampleType output_type,
+                     const PolyphaseFilter& filter, uint64_t samples_per_channel);
+
+    // 把包含num_channels个通道的WAV文件头写入header，数据超过4GB时生成RF64文件头，PCM输出时header为空
+    void MakeChannelHeader(uint64_t data_size, int num_channels, int bits_per_sample, uint16_t format_tag,
+                           uint32_t sample_rate, std::vector<uint8_t>& header) const;
+
+    // 流式/映射模式加载时准备输入源
+    bool PrepareDeferredInput();
+
+    // 取得data块中[offset, offset + bytes)的数据，映射模式下直接返回映射地址，否则读入block
+    // 不修改成员状态，多个线程可使用各自的block同时调用
+    const uint8_t* ReadBlock(RandomAccessFile& input, uint64_t offset, size_t bytes, uint8_t* block) const;
 
-    // 写入单通道WAV文件
-    bool WriteSingleChannelWav(const std::wstring& file_path, 
-                              const std::vector<uint8_t>& channel_data,
-                              int channel_index);
+    // 更新进度，仅在百分比变化时回调
+    void ReportProgress(uint64_t processed, uint64_t total);
 };
\ No newline at end of file
@@ -0,0 +1,482 @@
+// audio_benchmark.cpp : AudioProcessor各阶段的性能基准测试
+//
+// 用法: wav_split_bench [--large] [Google Benchmark选项]
+//   --large                         增加1 GB和4 GB输入（需要足够的磁盘和内存）
+//   --benchmark_format=json         以JSON输出结果，便于比较不同版本
+//   --benchmark_out=<file> --benchmark_out_format=json
+
+#include "async_writer.h"
+#include "audio_processor.h"
+#include "channel_stats.h"
+#include "deinterleave.h"
+#include "file_io.h"
+#include "file_list.h"
+#include "resampler.h"
+#include "sample_convert.h"
+#include "split_pipeline.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const int64_t kMegabyte = 1024 * 1024;
+const size_t kBlockSize = 4 * 1024 * 1024;
+
+fs::path BenchDirectory() {
+    fs::path dir = fs::temp_directory_path() / "wav_split_bench";
+    fs::create_directories(dir);
+    return dir;
+}
+
+// 用线性同余序列填充，避免全零数据被文件系统或压缩优化
+void FillSynthetic(uint8_t* data, size_t size, uint32_t& seed) {
+    for (size_t i = 0; i < size; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = static_cast<uint8_t>(seed >> 24);
+    }
+}
+
+// 生成（或复用已生成的）合成输入文件，data块大小向下对齐到block_align
+fs::path SyntheticInput(int bits, int channels, int64_t megabytes, bool wav) {
+    int block_align = bits / 8 * channels;
+    uint64_t data_size = static_cast<uint64_t>(megabytes * kMegabyte) / block_align * block_align;
+    std::string name = "in_" + std::to_string(bits) + "b_" + std::to_string(channels) + "ch_" +
+                       std::to_string(megabytes) + "mb" + (wav ? ".wav" : ".pcm");
+    fs::path path = BenchDirectory() / name;
+
+    std::error_code ec;
+    uint64_t expected = data_size + (wav ? sizeof(WAVHeader) : 0);
+    if (fs::file_size(path, ec) == expected && !ec) {
+        return path;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (wav) {
+        WAVHeader header = {};
+        std::memcpy(header.riff_id, "RIFF", 4);
+        std::memcpy(header.wave_id, "WAVE", 4);
+        std::memcpy(header.fmt_id, "fmt ", 4);
+        std::memcpy(header.data_id, "data", 4);
+        header.fmt_size = 16;
+        header.audio_format = 1;
+        header.num_channels = static_cast<uint16_t>(channels);
+        header.sample_rate = 48000;
+        header.bits_per_sample = static_cast<uint16_t>(bits);
+        header.block_align = static_cast<uint16_t>(block_align);
+        header.byte_rate = header.sample_rate * header.block_align;
+        header.data_size = static_cast<uint32_t>(std::min<uint64_t>(data_size, 0xFFFFFFFF - sizeof(WAVHeader) + 8));
+        header.file_size = header.data_size + sizeof(WAVHeader) - 8;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+
+    std::vector<uint8_t> block(kBlockSize);
+    uint32_t seed = static_cast<uint32_t>(bits * 131 + channels);
+    for (uint64_t written = 0; written < data_size;) {
+        size_t bytes = static_cast<size_t>(std::min<uint64_t>(block.size(), data_size - written));
+        FillSynthetic(block.data(), bytes, seed);
+        file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(bytes));
+        written += bytes;
+    }
+    return path;
+}
+
+AudioProcessor::AudioFormat MakeFormat(int bits, int channels) {
+    AudioProcessor::AudioFormat format;
+    format.sample_rate = 48000;
+    format.bits_per_sample = static_cast<uint16_t>(bits);
+    format.num_channels = static_cast<uint16_t>(channels);
+    return format;
+}
+
+void SetThroughput(benchmark::State& state, uint64_t bytes, uint64_t frames) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    state.counters["frames_per_second"] =
+        benchmark::Counter(static_cast<double>(frames), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+// 加载阶段：内存模式下把整个data块读入内存
+void BM_LoadWav(benchmark::State& state) {
+    int bits = static_cast<int>(state.range(0));
+    int channels = static_cast<int>(state.range(1));
+    fs::path input = SyntheticInput(bits, channels, state.range(2), true);
+
+    AudioProcessor processor;
+    processor.SetInputMode(AudioProcessor::InputMode::Memory);
+    for (auto _ : state) {
+        if (!processor.LoadWavFile(input.wstring())) {
+            state.SkipWithError("load failed");
+            return;
+        }
+    }
+    uint64_t bytes = processor.GetDataSize();
+    SetThroughput(state, bytes, bytes / (bits / 8 * channels));
+}
+
+// 通道分离阶段：只运行分派到的内核，不涉及文件读写
+void BM_Deinterleave(benchmark::State& state) {
+    int bits = static_cast<int>(state.range(0));
+    int channels = static_cast<int>(state.range(1));
+    int bytes_per_sample = bits / 8;
+    size_t frames = kBlockSize / (bytes_per_sample * channels);
+
+    std::vector<uint8_t> src(frames * bytes_per_sample * channels);
+    uint32_t seed = 1;
+    FillSynthetic(src.data(), src.size(), seed);
+    std::vector<std::vector<uint8_t>> channel_data(channels, std::vector<uint8_t>(frames * bytes_per_sample));
+    std::vector<uint8_t*> channel_ptrs(channels);
+    for (int ch = 0; ch < channels; ++ch) {
+        channel_ptrs[ch] = channel_data[ch].data();
+    }
+
+    DeinterleaveKernel kernel = SelectDeinterleaveKernel(bytes_per_sample, channels);
+    for (auto _ : state) {
+        kernel(src.data(), frames, bytes_per_sample, channels, channel_ptrs.data());
+        benchmark::ClobberMemory();
+    }
+    SetThroughput(state, src.size(), frames);
+}
+
+// 通道统计：交织数据的峰值、RMS、直流偏移、满幅计数和最长零样本段，与通道分离的吞吐量对比
+void BM_ChannelStats(benchmark::State& state) {
+    int bits = static_cast<int>(state.range(0));
+    int channels = static_cast<int>(state.range(1));
+    SampleType type = bits == 16 ? SampleType::Int16 : SampleType::Int24;
+    size_t frames = kBlockSize / (bits / 8 * channels);
+
+    std::vector<uint8_t> src(frames * (bits / 8) * channels);
+    uint32_t seed = 1;
+    FillSynthetic(src.data(), src.size(), seed);
+    std::vector<ChannelStats> stats(channels);
+    for (auto _ : state) {
+        AccumulateChannelStats(src.data(), frames, channels, type, stats.data());
+        benchmark::DoNotOptimize(stats.data());
+    }
+    SetThroughput(state, src.size(), frames);
+}
+
+// 样本格式转换：单通道连续样本，位深度32表示32位浮点
+void BM_ConvertSamples(benchmark::State& state) {
+    auto type_of = [](int64_t bits) {
+        return bits == 16 ? SampleType::Int16 : bits == 24 ? SampleType::Int24 : SampleType::Float32;
+    };
+    SampleType source = type_of(state.range(0));
+    SampleType target = type_of(state.range(1));
+    bool dither = state.range(2) != 0;
+    size_t count = kBlockSize / SampleTypeBytes(source);
+
+    std::vector<uint8_t> src(count * SampleTypeBytes(source));
+    uint32_t seed = 1;
+    FillSynthetic(src.data(), src.size(), seed);
+    if (source == SampleType::Float32) {
+        // 随机字节中会有NaN和超出满幅的值，改为[-1, 1)范围内的浮点数
+        float* samples = reinterpret_cast<float*>(src.data());
+        for (size_t i = 0; i < count; ++i) {
+            samples[i] = static_cast<int32_t>(i * 2654435761u) / 2147483648.0f;
+        }
+    }
+    std::vector<uint8_t> dst(count * SampleTypeBytes(target));
+
+    uint64_t first_frame = 0;
+    for (auto _ : state) {
+        ConvertSamples(src.data(), source, count, dst.data(), SampleTypeBytes(target), target,
+                       dither, first_frame, 0);
+        first_frame += count;
+        benchmark::ClobberMemory();
+    }
+    SetThroughput(state, src.size(), count);
+}
+
+// 单通道正弦信号分块重采样，返回全部输出
+std::vector<float> ResampleTone(const PolyphaseFilter& filter, double frequency, double input_rate, size_t count) {
+    const size_t kBlock = 4096;
+    std::vector<float> input(count);
+    for (size_t i = 0; i < count; ++i) {
+        input[i] = static_cast<float>(0.5 * std::sin(2.0 * 3.14159265358979323846 * frequency * i / input_rate));
+    }
+    ChannelResampler resampler;
+    resampler.Reset(&filter);
+    std::vector<float> output(static_cast<size_t>(filter.OutputFrames(count)) + resampler.MaxOutput(kBlock));
+    size_t produced = 0;
+    for (size_t done = 0; done < count; done += kBlock) {
+        produced += resampler.Process(input.data() + done, std::min(kBlock, count - done), output.data() + produced);
+    }
+    produced += resampler.Finish(output.data() + produced);
+    output.resize(produced);
+    return output;
+}
+
+// 输出中段与理想正弦（frequency高于输出奈奎斯特频率时为0）之差相对于信号的功率，单位dB
+double ToneErrorDb(const std::vector<float>& output, double frequency, double output_rate, bool rejected) {
+    double error = 0.0;
+    size_t begin = output.size() / 4;
+    size_t end = output.size() * 3 / 4;
+    for (size_t i = begin; i < end; ++i) {
+        double ideal = rejected ? 0.0 : 0.5 * std::sin(2.0 * 3.14159265358979323846 * frequency * i / output_rate);
+        error += (output[i] - ideal) * (output[i] - ideal);
+    }
+    return 10.0 * std::log10(error / (end - begin) / 0.125 + 1e-30);
+}
+
+// 重采样：单通道浮点样本的吞吐量，另外给出质量指标
+//   tone_error_db   1 kHz正弦的误差（越低越好）
+//   alias_db        高于输出奈奎斯特频率10%的正弦残留（降采样时，越低越好）
+void BM_Resample(benchmark::State& state) {
+    uint32_t input_rate = static_cast<uint32_t>(state.range(0));
+    uint32_t output_rate = static_cast<uint32_t>(state.range(1));
+    PolyphaseFilter filter;
+    if (!filter.Design(input_rate, output_rate)) {
+        state.SkipWithError("unsupported rate");
+        return;
+    }
+
+    size_t count = input_rate;  // 1秒
+    std::vector<float> input(count);
+    uint32_t seed = 1;
+    for (auto& sample : input) {
+        seed = seed * 1664525u + 1013904223u;
+        sample = static_cast<int32_t>(seed) / 4294967296.0f;
+    }
+    ChannelResampler resampler;
+    resampler.Reset(&filter);
+    std::vector<float> output(resampler.MaxOutput(count));
+    for (auto _ : state) {
+        resampler.Reset(&filter);
+        size_t produced = resampler.Process(input.data(), count, output.data());
+        benchmark::DoNotOptimize(produced);
+        benchmark::ClobberMemory();
+    }
+    SetThroughput(state, count * sizeof(float), count);
+
+    state.counters["tone_error_db"] =
+        ToneErrorDb(ResampleTone(filter, 1000.0, input_rate, count * 2), 1000.0, output_rate, false);
+    if (output_rate < input_rate) {
+        double alias = output_rate * 0.55;
+        state.counters["alias_db"] =
+            ToneErrorDb(ResampleTone(filter, alias, input_rate, count * 2), alias, output_rate, true);
+    }
+}
+
+// 写入阶段：按SplitChannels的方式将各通道数据块按偏移写入单通道文件
+void BM_WriteChannels(benchmark::State& state) {
+    int bits = static_cast<int>(state.range(0));
+    int channels = static_cast<int>(state.range(1));
+    uint64_t total = static_cast<uint64_t>(state.range(2) * kMegabyte);
+    size_t channel_block = kBlockSize / channels;
+    uint64_t channel_size = total / channels;
+
+    std::vector<uint8_t> data(channel_block);
+    uint32_t seed = 2;
+    FillSynthetic(data.data(), data.size(), seed);
+
+    AsyncWriter writer(channels);
+    std::vector<std::unique_ptr<RandomAccessFile>> outputs(channels);
+    for (auto _ : state) {
+        for (int ch = 0; ch < channels; ++ch) {
+            outputs[ch] = std::make_unique<RandomAccessFile>();
+            fs::path path = BenchDirectory() / ("out_" + std::to_string(ch + 1) + ".pcm");
+            if (!outputs[ch]->Open(path.wstring(), RandomAccessFile::Mode::Create)) {
+                state.SkipWithError("open failed");
+                return;
+            }
+        }
+        AsyncWriter::Batch batch;
+        for (uint64_t offset = 0; offset < channel_size; offset += channel_block) {
+            size_t bytes = static_cast<size_t>(std::min<uint64_t>(channel_block, channel_size - offset));
+            for (int ch = 0; ch < channels; ++ch) {
+                writer.Write(*outputs[ch], offset, data.data(), bytes, batch);
+            }
+        }
+        if (!batch.Wait()) {
+            state.SkipWithError("write failed");
+            return;
+        }
+    }
+    SetThroughput(state, channel_size * channels, channel_size / (bits / 8));
+}
+
+// 完整拆分：流式读取、通道分离并写出全部通道文件
+void BM_SplitChannels(benchmark::State& state) {
+    int bits = static_cast<int>(state.range(0));
+    int channels = static_cast<int>(state.range(1));
+    fs::path input = SyntheticInput(bits, channels, state.range(2), state.range(3) != 0);
+
+    AudioProcessor processor;
+    processor.SetInputMode(AudioProcessor::InputMode::Stream);
+    processor.SetOutputFormat(AudioProcessor::OutputFormat::WAV);
+    for (auto _ : state) {
+        processor.SetAudioFormat(MakeFormat(bits, channels));
+        if (!processor.LoadWavFile(input.wstring())) {
+            state.SkipWithError("load failed");
+            return;
+        }
+        processor.SetAudioFormat(MakeFormat(bits, channels));
+        if (!processor.SplitChannels(BenchDirectory().wstring())) {
+            state.SkipWithError("split failed");
+            return;
+        }
+    }
+    uint64_t bytes = processor.GetDataSize();
+    SetThroughput(state, bytes, bytes / (bits / 8 * channels));
+    // 缓冲区在迭代之间复用，稳定状态下最后一次拆分应没有缓冲区分配
+    state.counters["allocations"] = static_cast<double>(processor.GetLastMetrics().allocation_count);
+}
+
+// 批量拆分：4个工作线程处理一批文件，pipeline=0为每线程完整处理一个文件，
+// pipeline=1为工作线程共用读取/分离/写入流水线
+void BM_SplitBatch(benchmark::State& state) {
+    int files = static_cast<int>(state.range(0));
+    int64_t megabytes = state.range(1);
+    bool use_pipeline = state.range(2) != 0;
+    const int bits = 16;
+    const int channels = 4;
+    const int worker_count = 4;
+
+    // 每个文件复制到自己的子目录，输出文件互不覆盖
+    fs::path source = SyntheticInput(bits, channels, megabytes, true);
+    std::vector<std::wstring> inputs;
+    for (int i = 0; i < files; ++i) {
+        fs::path dir = BenchDirectory() / ("batch_" + std::to_string(i));
+        fs::create_directories(dir);
+        fs::path path = dir / source.filename();
+        std::error_code ec;
+        if (fs::file_size(path, ec) != fs::file_size(source) || ec) {
+            fs::copy_file(source, path, fs::copy_options::overwrite_existing);
+        }
+        inputs.push_back(path.wstring());
+    }
+
+    std::shared_ptr<SplitPipeline> pipeline;
+    if (use_pipeline) {
+        SplitPipeline::Options options;
+        options.block_bytes = kBlockSize;
+        pipeline = std::make_shared<SplitPipeline>(options);
+    }
+
+    std::atomic<bool> failed(false);
+    for (auto _ : state) {
+        std::atomic<int> next(0);
+        std::vector<std::thread> workers;
+        for (int i = 0; i < worker_count; ++i) {
+            workers.emplace_back([&] {
+                AudioProcessor processor;
+                processor.SetInputMode(AudioProcessor::InputMode::Stream);
+                processor.SetOutputFormat(AudioProcessor::OutputFormat::WAV);
+                processor.SetStreamBufferSize(kBlockSize);
+                processor.SetPipeline(pipeline);
+                for (int index = next++; index < files; index = next++) {
+                    processor.SetAudioFormat(MakeFormat(bits, channels));
+                    if (!processor.LoadWavFile(inputs[index]) ||
+                        !processor.SplitChannels(fs::path(inputs[index]).parent_path().wstring())) {
+                        failed = true;
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (failed) {
+            state.SkipWithError("split failed");
+            return;
+        }
+    }
+    uint64_t bytes = static_cast<uint64_t>(files) * (fs::file_size(source) - sizeof(WAVHeader));
+    SetThroughput(state, bytes, bytes / (bits / 8 * channels));
+}
+
+// 导入文件列表：逐个添加路径并去重，其中十分之一是大小写不同的重复路径
+void BM_ImportFileList(benchmark::State& state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    std::vector<std::wstring> paths;
+    paths.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (i % 10 == 9) {
+            std::wstring duplicate = paths[i / 2];
+            std::transform(duplicate.begin(), duplicate.end(), duplicate.begin(), std::towupper);
+            paths.push_back(duplicate);
+        } else {
+            paths.push_back(L"D:\\Recordings\\session_" + std::to_wstring(i / 100) +
+                            L"\\take_" + std::to_wstring(i) + L".wav");
+        }
+    }
+
+    for (auto _ : state) {
+        FileList list;
+        for (const auto& path : paths) {
+            list.Add(path);
+        }
+        benchmark::DoNotOptimize(list.Size());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+
+void RegisterBenchmarks(bool large) {
+    std::vector<int64_t> bits = {8, 16, 24, 32};
+    std::vector<int64_t> channels = {2, 4, 6, 8};
+    std::vector<int64_t> sizes = {1, 64};
+    if (large) {
+        sizes.push_back(1024);
+        sizes.push_back(4096);
+    }
+
+    benchmark::RegisterBenchmark("BM_LoadWav", BM_LoadWav)
+        ->ArgsProduct({bits, channels, sizes})->ArgNames({"bits", "ch", "mb"})
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+    benchmark::RegisterBenchmark("BM_Deinterleave", BM_Deinterleave)
+        ->ArgsProduct({bits, channels})->ArgNames({"bits", "ch"});
+    benchmark::RegisterBenchmark("BM_ChannelStats", BM_ChannelStats)
+        ->ArgsProduct({{16, 24}, channels})->ArgNames({"bits", "ch"});
+    benchmark::RegisterBenchmark("BM_ConvertSamples", BM_ConvertSamples)
+        ->ArgsProduct({{16, 24, 32}, {16, 24, 32}, {0, 1}})->ArgNames({"src", "dst", "dither"});
+    benchmark::RegisterBenchmark("BM_Resample", BM_Resample)
+        ->Args({48000, 16000})->Args({44100, 16000})->Args({16000, 48000})->Args({44100, 48000})
+        ->ArgNames({"in", "out"});
+    benchmark::RegisterBenchmark("BM_WriteChannels", BM_WriteChannels)
+        ->ArgsProduct({{16}, channels, sizes})->ArgNames({"bits", "ch", "mb"})
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+    benchmark::RegisterBenchmark("BM_SplitChannels", BM_SplitChannels)
+        ->ArgsProduct({bits, channels, sizes, {1, 0}})->ArgNames({"bits", "ch", "mb", "wav"})
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+    benchmark::RegisterBenchmark("BM_SplitBatch", BM_SplitBatch)
+        ->ArgsProduct({{16}, {16}, {0, 1}})->ArgNames({"files", "mb", "pipeline"})
+        ->Unit(benchmark::kMillisecond)->UseRealTime();
+    benchmark::RegisterBenchmark("BM_ImportFileList", BM_ImportFileList)
+        ->Arg(10000)->Arg(100000)->ArgName("files")->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // 先取出本程序自己的选项，其余交给Google Benchmark解析
+    bool large = false;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--large") == 0) {
+            large = true;
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+    int bench_argc = static_cast<int>(args.size());
+
+    RegisterBenchmarks(large);
+    benchmark::Initialize(&bench_argc, args.data());
+    if (benchmark::ReportUnrecognizedArguments(bench_argc, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
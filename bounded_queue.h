@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// 有界多生产者多消费者队列：入队出队本身无锁（每个槽位带序号的环形数组），
+// 只有在队列满或空需要休眠时才使用互斥锁和条件变量
+template <typename T>
+class BoundedQueue {
+public:
+    // 容量向上取整到2的幂
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        cells_.reset(new Cell[size]);
+        mask_ = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // 队列满时返回false
+    bool TryPush(T& value) {
+        if (!Enqueue(value)) {
+            return false;
+        }
+        Wake(pop_waiters_);
+        return true;
+    }
+
+    // 队列空时返回false
+    bool TryPop(T& value) {
+        if (!Dequeue(value)) {
+            return false;
+        }
+        Wake(push_waiters_);
+        return true;
+    }
+
+    // 入队，队列满时等待
+    void Push(T value) {
+        if (TryPush(value)) {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            push_waiters_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!Enqueue(value)) {
+                cv_.wait(lock);
+            }
+            push_waiters_.fetch_sub(1);
+        }
+        Wake(pop_waiters_);
+    }
+
+    // 出队，队列空时等待；Close()之后队列取空时返回false
+    bool Pop(T& value) {
+        if (TryPop(value)) {
+            return true;
+        }
+        bool popped;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            pop_waiters_.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            while (!(popped = Dequeue(value)) && !closed_) {
+                cv_.wait(lock);
+            }
+            pop_waiters_.fetch_sub(1);
+        }
+        if (popped) {
+            Wake(push_waiters_);
+        }
+        return popped;
+    }
+
+    // 不再入队，唤醒所有等待出队的线程
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    bool Enqueue(T& value) {
+        size_t position = enqueue_position_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0) {
+                if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = enqueue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool Dequeue(T& value) {
+        size_t position = dequeue_position_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (diff == 0) {
+                if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = dequeue_position_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 等待方先登记再检查队列，这里先修改队列再检查登记，两边都用顺序一致的内存序，不会漏掉唤醒
+    void Wake(std::atomic<int>& waiters) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load() > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    // 入队和出队位置分别放在独立的缓存行中，避免生产者和消费者互相干扰
+    alignas(64) std::atomic<size_t> enqueue_position_{0};
+    alignas(64) std::atomic<size_t> dequeue_position_{0};
+
+    alignas(64) std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<int> push_waiters_{0};
+    std::atomic<int> pop_waiters_{0};
+    bool closed_ = false;
+};
@@ -0,0 +1,46 @@
+#include "buffer_arena.h"
+
+uint8_t* BufferArena::Acquire(size_t slot, size_t size) {
+    if (slot >= slots_.size()) {
+        if (slot >= slots_.capacity()) {
+            ++allocation_count_;
+            allocated_bytes_ += (slot + 1) * sizeof(Slot);
+        }
+        slots_.resize(slot + 1);
+    }
+
+    Slot& entry = slots_[slot];
+    if (entry.capacity < size) {
+        entry.data.reset(new uint8_t[size]);
+        entry.capacity = size;
+        ++allocation_count_;
+        allocated_bytes_ += size;
+    }
+    return entry.data.get();
+}
+
+uint8_t** BufferArena::AcquirePointers(size_t count) {
+    if (count > pointers_.capacity()) {
+        ++allocation_count_;
+        allocated_bytes_ += count * sizeof(uint8_t*);
+    }
+    if (count > pointers_.size()) {
+        pointers_.resize(count);
+    }
+    return pointers_.data();
+}
+
+void BufferArena::Release() {
+    slots_.clear();
+    slots_.shrink_to_fit();
+    pointers_.clear();
+    pointers_.shrink_to_fit();
+}
+
+uint64_t BufferArena::ReservedBytes() const {
+    uint64_t total = pointers_.capacity() * sizeof(uint8_t*);
+    for (const auto& slot : slots_) {
+        total += slot.capacity;
+    }
+    return total;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 跨文件复用的缓冲区集合：缓冲区只增长不释放，处理下一个文件时直接复用，
+// 稳定状态下（文件格式和缓冲区大小不变）不再分配堆内存
+// 非线程安全，多线程使用时应先在调用线程上取得全部缓冲区
+class BufferArena {
+public:
+    // 取得编号为slot、至少size字节的缓冲区，容量不足时重新分配（原内容不保留）
+    uint8_t* Acquire(size_t slot, size_t size);
+
+    // 取得至少count个元素的指针表，用于存放各通道缓冲区地址
+    uint8_t** AcquirePointers(size_t count);
+
+    // 释放全部缓冲区
+    void Release();
+
+    // 累计分配次数和字节数，用于统计和验证稳定状态下没有分配
+    uint64_t AllocationCount() const { return allocation_count_; }
+    uint64_t AllocatedBytes() const { return allocated_bytes_; }
+
+    // 当前持有的缓冲区总字节数
+    uint64_t ReservedBytes() const;
+
+private:
+    struct Slot {
+        std::unique_ptr<uint8_t[]> data;
+        size_t capacity = 0;
+    };
+
+    std::vector<Slot> slots_;
+    std::vector<uint8_t*> pointers_;
+    uint64_t allocation_count_ = 0;
+    uint64_t allocated_bytes_ = 0;
+};
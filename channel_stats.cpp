@@ -0,0 +1,301 @@
+#include "channel_stats.h"
+#include "deinterleave.h"
+#include "sample_convert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CHANNEL_STATS_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 每段统计的帧数，分离后的整数样本和浮点样本都位于L1缓存
+const size_t kChunkFrames = 1024;
+
+// 正满幅的浮点值：整数格式为最大码值，浮点格式为1.0；负满幅均为-1.0
+float ClipHigh(SampleType type) {
+    switch (type) {
+        case SampleType::UInt8: return 127.0f / 128.0f;
+        case SampleType::Int16: return 32767.0f / 32768.0f;
+        case SampleType::Int24: return 8388607.0f / 8388608.0f;
+        default: return 1.0f;
+    }
+}
+
+// 统计一段样本，peak、和与满幅计数用SIMD计算，零样本连续段由比较掩码逐组判断
+ChannelStats SegmentStats(const float* x, size_t count, float high) {
+    ChannelStats stats;
+    stats.samples = count;
+    float peak = 0.0f;
+    float sum = 0.0f;
+    float sum_squares = 0.0f;
+    uint64_t clipped = 0;
+    uint64_t run = 0;
+    bool seen_nonzero = false;
+    auto end_run = [&] {
+        if (!seen_nonzero) {
+            stats.leading_zeros = run;
+            seen_nonzero = true;
+        }
+        stats.zero_run = std::max(stats.zero_run, run);
+        run = 0;
+    };
+
+    size_t i = 0;
+#ifdef CHANNEL_STATS_X86
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 vlow = _mm_set1_ps(-1.0f);
+    const __m128 vhigh = _mm_set1_ps(high);
+    __m128 vpeak = zero;
+    __m128 vsum = zero;
+    __m128 vsquares = zero;
+    __m128i vclipped = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        vpeak = _mm_max_ps(vpeak, _mm_andnot_ps(sign, v));
+        vsum = _mm_add_ps(vsum, v);
+        vsquares = _mm_add_ps(vsquares, _mm_mul_ps(v, v));
+        // 比较结果为全1（即-1），减去后相当于计数加1
+        __m128 clip = _mm_or_ps(_mm_cmple_ps(v, vlow), _mm_cmpge_ps(v, vhigh));
+        vclipped = _mm_sub_epi32(vclipped, _mm_castps_si128(clip));
+
+        int zeros = _mm_movemask_ps(_mm_cmpeq_ps(v, zero));
+        if (zeros == 0xF) {
+            run += 4;
+        } else if (zeros == 0) {
+            if (run > 0 || !seen_nonzero) {
+                end_run();
+            }
+        } else {
+            for (int k = 0; k < 4; ++k) {
+                if (zeros & (1 << k)) {
+                    ++run;
+                } else {
+                    end_run();
+                }
+            }
+        }
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, vpeak);
+    peak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    _mm_store_ps(lanes, vsum);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm_store_ps(lanes, vsquares);
+    sum_squares = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    alignas(16) int32_t counts[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(counts), vclipped);
+    clipped = static_cast<uint64_t>(counts[0]) + counts[1] + counts[2] + counts[3];
+#endif
+    for (; i < count; ++i) {
+        float v = x[i];
+        peak = std::max(peak, std::fabs(v));
+        sum += v;
+        sum_squares += v * v;
+        if (v <= -1.0f || v >= high) {
+            ++clipped;
+        }
+        if (v == 0.0f) {
+            ++run;
+        } else {
+            end_run();
+        }
+    }
+
+    stats.trailing_zeros = run;
+    if (!seen_nonzero) {
+        stats.leading_zeros = run;
+    }
+    stats.zero_run = std::max(stats.zero_run, run);
+    stats.peak = peak;
+    stats.sum = sum;
+    stats.sum_squares = sum_squares;
+    stats.clipped = clipped;
+    return stats;
+}
+
+// 以dBFS表示的幅度写入text，静音时没有有限值，写入missing（JSON为null，CSV为空字段）
+void FormatDb(double value, const char* missing, char* text, size_t size) {
+    if (value <= 0.0) {
+        std::snprintf(text, size, "%s", missing);
+        return;
+    }
+    std::snprintf(text, size, "%.2f", 20.0 * std::log10(value));
+}
+
+} // namespace
+
+double ChannelStats::Rms() const {
+    return samples > 0 ? std::sqrt(sum_squares / static_cast<double>(samples)) : 0.0;
+}
+
+double ChannelStats::DcOffset() const {
+    return samples > 0 ? sum / static_cast<double>(samples) : 0.0;
+}
+
+void ChannelStats::Append(const ChannelStats& next) {
+    if (next.samples == 0) {
+        return;
+    }
+    if (samples == 0) {
+        *this = next;
+        return;
+    }
+    zero_run = std::max(std::max(zero_run, next.zero_run), trailing_zeros + next.leading_zeros);
+    if (leading_zeros == samples) {
+        leading_zeros += next.leading_zeros;
+    }
+    trailing_zeros = next.trailing_zeros == next.samples ? trailing_zeros + next.samples : next.trailing_zeros;
+    samples += next.samples;
+    peak = std::max(peak, next.peak);
+    sum += next.sum;
+    sum_squares += next.sum_squares;
+    clipped += next.clipped;
+}
+
+void AccumulateFloatStats(const float* samples, size_t count, SampleType type, ChannelStats& stats) {
+    // 单精度累加只在一段之内进行，段之间用双精度合并，长文件的和不会丢失精度
+    float high = ClipHigh(type);
+    for (size_t done = 0; done < count; done += kChunkFrames) {
+        size_t n = std::min(kChunkFrames, count - done);
+        stats.Append(SegmentStats(samples + done, n, high));
+    }
+}
+
+void AccumulateChannelStats(const uint8_t* src, size_t frames, int num_channels, SampleType type,
+                            ChannelStats* stats) {
+    int bytes_per_sample = SampleTypeBytes(type);
+    size_t frame_bytes = static_cast<size_t>(bytes_per_sample) * num_channels;
+    DeinterleaveKernel kernel = SelectDeinterleaveKernel(bytes_per_sample, num_channels);
+    float high = ClipHigh(type);
+
+    // 临时缓冲区按线程保留，分段线程和流水线线程稳定后不再分配
+    thread_local std::vector<uint8_t> scratch;
+    thread_local std::vector<uint8_t*> scratch_ptrs;
+    size_t channel_bytes = kChunkFrames * bytes_per_sample;
+    if (scratch.size() < channel_bytes * num_channels) {
+        scratch.resize(channel_bytes * num_channels);
+    }
+    scratch_ptrs.resize(num_channels);
+    for (int ch = 0; ch < num_channels; ++ch) {
+        scratch_ptrs[ch] = scratch.data() + ch * channel_bytes;
+    }
+
+    float values[kChunkFrames];
+    for (size_t done = 0; done < frames; done += kChunkFrames) {
+        size_t count = std::min(kChunkFrames, frames - done);
+        kernel(src + done * frame_bytes, count, bytes_per_sample, num_channels, scratch_ptrs.data());
+        for (int ch = 0; ch < num_channels; ++ch) {
+            SamplesToFloat(scratch_ptrs[ch], type, count, values);
+            stats[ch].Append(SegmentStats(values, count, high));
+        }
+    }
+}
+
+void AccumulateSplitStats(const uint8_t* const* channels, size_t frames, int num_channels, SampleType type,
+                          ChannelStats* stats) {
+    int bytes_per_sample = SampleTypeBytes(type);
+    float high = ClipHigh(type);
+    // 分段方式与AccumulateChannelStats相同，两者的结果逐位相同
+    float values[kChunkFrames];
+    for (size_t done = 0; done < frames; done += kChunkFrames) {
+        size_t count = std::min(kChunkFrames, frames - done);
+        for (int ch = 0; ch < num_channels; ++ch) {
+            SamplesToFloat(channels[ch] + done * bytes_per_sample, type, count, values);
+            stats[ch].Append(SegmentStats(values, count, high));
+        }
+    }
+}
+
+bool IsAllValue(const uint8_t* data, size_t size, uint8_t value) {
+    size_t i = 0;
+#ifdef CHANNEL_STATS_X86
+    // 每次检查64字节，与value异或后按位或，结果为零说明全部相等，遇到不等立即返回
+    const __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 64 <= size; i += 64) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(data + i);
+        __m128i v = _mm_or_si128(
+            _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(p), pattern), _mm_xor_si128(_mm_loadu_si128(p + 1), pattern)),
+            _mm_or_si128(_mm_xor_si128(_mm_loadu_si128(p + 2), pattern), _mm_xor_si128(_mm_loadu_si128(p + 3), pattern)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xFFFF) {
+            return false;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (data[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ChannelStatsCollector::Reset(int num_channels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    num_channels_ = num_channels;
+    blocks_.clear();
+    stats_.clear();
+}
+
+void ChannelStatsCollector::Add(uint64_t first_frame, const ChannelStats* stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_.emplace_back(first_frame, stats_.size());
+    stats_.insert(stats_.end(), stats, stats + num_channels_);
+}
+
+void ChannelStatsCollector::Merge(std::vector<ChannelStats>& merged) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::sort(blocks_.begin(), blocks_.end());
+    merged.assign(num_channels_, ChannelStats());
+    for (const auto& block : blocks_) {
+        for (int ch = 0; ch < num_channels_; ++ch) {
+            merged[ch].Append(stats_[block.second + ch]);
+        }
+    }
+    blocks_.clear();
+    stats_.clear();
+}
+
+std::string ChannelStatsJson(const std::vector<ChannelStats>& stats) {
+    std::string json = "[";
+    char buf[384];
+    for (size_t ch = 0; ch < stats.size(); ++ch) {
+        const ChannelStats& s = stats[ch];
+        char peak_text[32];
+        char rms_text[32];
+        FormatDb(s.peak, "null", peak_text, sizeof(peak_text));
+        FormatDb(s.Rms(), "null", rms_text, sizeof(rms_text));
+        std::snprintf(buf, sizeof(buf),
+            "%s{\"channel\":%zu,\"samples\":%llu,\"peak\":%.6g,\"peak_dbfs\":%s,\"rms\":%.6g,\"rms_dbfs\":%s,"
+            "\"dc_offset\":%.6g,\"clipped\":%llu,\"zero_run\":%llu}",
+            ch > 0 ? "," : "", ch + 1, static_cast<unsigned long long>(s.samples), s.peak, peak_text,
+            s.Rms(), rms_text, s.DcOffset(), static_cast<unsigned long long>(s.clipped),
+            static_cast<unsigned long long>(s.zero_run));
+        json += buf;
+    }
+    json += "]";
+    return json;
+}
+
+std::string ChannelStatsCsv(const std::vector<ChannelStats>& stats) {
+    std::string csv = "channel,samples,peak,peak_dbfs,rms,rms_dbfs,dc_offset,clipped,zero_run\n";
+    char buf[256];
+    for (size_t ch = 0; ch < stats.size(); ++ch) {
+        const ChannelStats& s = stats[ch];
+        char peak_text[32];
+        char rms_text[32];
+        FormatDb(s.peak, "", peak_text, sizeof(peak_text));
+        FormatDb(s.Rms(), "", rms_text, sizeof(rms_text));
+        std::snprintf(buf, sizeof(buf), "%zu,%llu,%.6g,%s,%.6g,%s,%.6g,%llu,%llu\n",
+                      ch + 1, static_cast<unsigned long long>(s.samples), s.peak, peak_text, s.Rms(), rms_text,
+                      s.DcOffset(), static_cast<unsigned long long>(s.clipped),
+                      static_cast<unsigned long long>(s.zero_run));
+        csv += buf;
+    }
+    return csv;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class SampleType;
+
+// 单个通道的统计结果，样本按满幅为1的浮点数计算
+struct ChannelStats {
+    uint64_t samples = 0;
+    float peak = 0.0f;              // 最大绝对值
+    double sum = 0.0;               // 样本之和，用于计算直流偏移
+    double sum_squares = 0.0;       // 平方和，用于计算RMS
+    uint64_t clipped = 0;           // 达到正负满幅的样本数
+    uint64_t zero_run = 0;          // 最长的连续零样本数
+    uint64_t leading_zeros = 0;     // 开头的连续零样本数，分块统计时用于合并
+    uint64_t trailing_zeros = 0;    // 末尾的连续零样本数
+
+    double Rms() const;
+    double DcOffset() const;
+
+    // 在本段之后接上next段的统计结果，跨段的零样本连续段会被合并
+    void Append(const ChannelStats& next);
+};
+
+// 统计交织数据中frames帧的各通道，结果按时间顺序接在stats[0..num_channels-1]之后
+// 每次取一小段先分离到线程内的临时缓冲区再转换为浮点，统计在缓存中完成，src只读取一次
+void AccumulateChannelStats(const uint8_t* src, size_t frames, int num_channels, SampleType type,
+                            ChannelStats* stats);
+
+// 与AccumulateChannelStats相同，但各通道已分离到channels[0..num_channels-1]，不再重新分离
+void AccumulateSplitStats(const uint8_t* const* channels, size_t frames, int num_channels, SampleType type,
+                          ChannelStats* stats);
+
+// 统计连续的浮点样本，结果接在stats之后，type为源样本格式，决定满幅的判断
+void AccumulateFloatStats(const float* samples, size_t count, SampleType type, ChannelStats& stats);
+
+// data的size字节是否都等于value，用于找出不必写入的静音输出块（8位样本的静音为0x80，其余格式为0）
+bool IsAllValue(const uint8_t* data, size_t size, uint8_t value);
+
+// 分段线程和流水线中各块的统计结果乱序到达，按起始帧排序后再依次合并
+// 各块的结果依次存放在同一个数组中，容量在文件之间保留，稳定状态下添加和合并都不分配内存
+class ChannelStatsCollector {
+public:
+    void Reset(int num_channels);
+
+    // 添加从first_frame开始的一块的统计结果stats[0..num_channels-1]，可由多个线程同时调用
+    void Add(uint64_t first_frame, const ChannelStats* stats);
+
+    // 按帧顺序合并全部块，每个通道的统计结果写入merged
+    void Merge(std::vector<ChannelStats>& merged);
+
+private:
+    int num_channels_ = 0;
+    std::mutex mutex_;
+    std::vector<std::pair<uint64_t, size_t>> blocks_;   // 各块的起始帧和在stats_中的位置
+    std::vector<ChannelStats> stats_;
+};
+
+// 统计结果的JSON数组，每个元素对应一个通道；静音通道的dBFS没有有限值，两种格式都留空（JSON为null）
+std::string ChannelStatsJson(const std::vector<ChannelStats>& stats);
+
+// 统计结果的CSV文本，第一行为列名，之后每行一个通道
+std::string ChannelStatsCsv(const std::vector<ChannelStats>& stats);
@@ -0,0 +1,329 @@
+#include "deinterleave.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define DEINTERLEAVE_X86 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+void DeinterleaveScalar(const uint8_t* src, size_t frames,
+                        int bytes_per_sample, int num_channels,
+                        uint8_t* const* dst) {
+    size_t block_align = static_cast<size_t>(bytes_per_sample) * num_channels;
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t* frame = src + i * block_align;
+        for (int ch = 0; ch < num_channels; ++ch) {
+            std::memcpy(dst[ch] + i * bytes_per_sample, frame + ch * bytes_per_sample, bytes_per_sample);
+        }
+    }
+}
+
+namespace {
+
+// 编译期确定位深度的通道抽取，单个样本的复制可内联为一次读写
+template <int B>
+void GatherFixed(const uint8_t* src, size_t frames, int num_channels, const int* channels, int count, uint8_t* dst) {
+    size_t block_align = static_cast<size_t>(B) * num_channels;
+    if (count == 1) {
+        const uint8_t* in = src + static_cast<size_t>(channels[0]) * B;
+        for (size_t i = 0; i < frames; ++i) {
+            std::memcpy(dst + i * B, in + i * block_align, B);
+        }
+        return;
+    }
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t* frame = src + i * block_align;
+        uint8_t* out = dst + i * B * count;
+        for (int k = 0; k < count; ++k) {
+            std::memcpy(out + k * B, frame + static_cast<size_t>(channels[k]) * B, B);
+        }
+    }
+}
+
+} // namespace
+
+void GatherChannels(const uint8_t* src, size_t frames,
+                    int bytes_per_sample, int num_channels,
+                    const int* channels, int count, uint8_t* dst) {
+    switch (bytes_per_sample) {
+        case 1: GatherFixed<1>(src, frames, num_channels, channels, count, dst); return;
+        case 2: GatherFixed<2>(src, frames, num_channels, channels, count, dst); return;
+        case 3: GatherFixed<3>(src, frames, num_channels, channels, count, dst); return;
+        case 4: GatherFixed<4>(src, frames, num_channels, channels, count, dst); return;
+        default: break;
+    }
+    size_t block_align = static_cast<size_t>(bytes_per_sample) * num_channels;
+    for (size_t i = 0; i < frames; ++i) {
+        const uint8_t* frame = src + i * block_align;
+        uint8_t* out = dst + i * bytes_per_sample * count;
+        for (int k = 0; k < count; ++k) {
+            std::memcpy(out + k * bytes_per_sample, frame + static_cast<size_t>(channels[k]) * bytes_per_sample,
+                        bytes_per_sample);
+        }
+    }
+}
+
+namespace {
+
+// 编译期确定位深度和通道数的通道分离器，内层循环可被完全展开
+template <int B, int C>
+struct Deinterleaver {
+    static void Run(const uint8_t* src, size_t frames, int, int, uint8_t* const* dst) {
+        constexpr size_t kFrameBytes = static_cast<size_t>(B) * C;
+        uint8_t* out[C];
+        for (int ch = 0; ch < C; ++ch) {
+            out[ch] = dst[ch];
+        }
+        for (size_t i = 0; i < frames; ++i) {
+            const uint8_t* frame = src + i * kFrameBytes;
+            for (int ch = 0; ch < C; ++ch) {
+                std::memcpy(out[ch] + i * B, frame + ch * B, B);
+            }
+        }
+    }
+};
+
+// 界面提供的通道数选项
+constexpr int kChannelOptions[] = { 2, 4, 6, 8 };
+constexpr int kMaxBytesPerSample = 4;
+constexpr int kChannelOptionCount = sizeof(kChannelOptions) / sizeof(kChannelOptions[0]);
+
+int ChannelOptionIndex(int num_channels) {
+    for (int i = 0; i < kChannelOptionCount; ++i) {
+        if (kChannelOptions[i] == num_channels) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+template <int B>
+constexpr DeinterleaveKernel kSpecializedRow[kChannelOptionCount] = {
+    Deinterleaver<B, 2>::Run, Deinterleaver<B, 4>::Run,
+    Deinterleaver<B, 6>::Run, Deinterleaver<B, 8>::Run
+};
+
+// 各布局实测更快的内核：true表示模板特化版本快于SIMD版本（4 MB整块和96 KB缓存内两种大小都是如此）
+// 8/16位4通道时模板版本被编译器向量化，比SIMD多级重排快约50%；
+// 32位4/6/8通道两者相当，整字搬运更简单；24位和8/16位6通道没有SIMD版本
+constexpr bool kPreferSpecialized[kMaxBytesPerSample][kChannelOptionCount] = {
+    //  2ch    4ch    6ch    8ch
+    { false, true,  false, false },     // 8位
+    { false, true,  false, false },     // 16位
+    { false, false, false, false },     // 24位
+    { false, true,  true,  true  },     // 32位
+};
+
+// 分派表：以(位深度字节数-1, 通道数选项)为索引
+struct KernelTable {
+    DeinterleaveKernel kernels[kMaxBytesPerSample][kChannelOptionCount];
+};
+
+KernelTable BuildKernelTable(SimdLevel level) {
+    KernelTable table = {};
+    for (int b = 1; b <= kMaxBytesPerSample; ++b) {
+        for (int i = 0; i < kChannelOptionCount; ++i) {
+            int ch = kChannelOptions[i];
+            bool prefer_specialized = kPreferSpecialized[b - 1][i];
+            DeinterleaveKernel kernel = nullptr;
+            if (level == SimdLevel::AVX2 && !prefer_specialized) {
+                kernel = GetAvx2DeinterleaveKernel(b, ch);
+            }
+            if (!kernel && level != SimdLevel::Scalar && !prefer_specialized) {
+                kernel = GetSse2DeinterleaveKernel(b, ch);
+            }
+            table.kernels[b - 1][i] = kernel ? kernel : GetSpecializedDeinterleaveKernel(b, ch);
+        }
+    }
+    return table;
+}
+
+} // namespace
+
+DeinterleaveKernel GetSpecializedDeinterleaveKernel(int bytes_per_sample, int num_channels) {
+    int index = ChannelOptionIndex(num_channels);
+    if (index < 0) {
+        return nullptr;
+    }
+    switch (bytes_per_sample) {
+        case 1: return kSpecializedRow<1>[index];
+        case 2: return kSpecializedRow<2>[index];
+        case 3: return kSpecializedRow<3>[index];
+        case 4: return kSpecializedRow<4>[index];
+        default: return nullptr;
+    }
+}
+
+#ifdef DEINTERLEAVE_X86
+
+namespace {
+
+// 多级奇偶拆分后寄存器k中保存的是第BitReverse(k)个通道
+constexpr int BitReverse(int index, int count) {
+    int result = 0;
+    for (int bit = 1; bit < count; bit <<= 1) {
+        result = (result << 1) | (index & 1);
+        index >>= 1;
+    }
+    return result;
+}
+
+// 将a、b两个寄存器中的W字节元素拆分为偶数位和奇数位两组，保持时间顺序
+template <int W>
+inline void SplitEvenOdd(__m128i a, __m128i b, __m128i& even, __m128i& odd);
+
+template <>
+inline void SplitEvenOdd<1>(__m128i a, __m128i b, __m128i& even, __m128i& odd) {
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    even = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+    odd = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+}
+
+template <>
+inline void SplitEvenOdd<2>(__m128i a, __m128i b, __m128i& even, __m128i& odd) {
+    // 先符号扩展到32位，饱和打包时数值不会改变
+    even = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+                           _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+    odd = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+}
+
+template <>
+inline void SplitEvenOdd<4>(__m128i a, __m128i b, __m128i& even, __m128i& odd) {
+    __m128 fa = _mm_castsi128_ps(a);
+    __m128 fb = _mm_castsi128_ps(b);
+    even = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+    odd = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+// C个寄存器经过log2(C)级奇偶拆分，每个寄存器只剩一个通道的数据
+template <int W, int C>
+inline void SplitLevels(__m128i* r) {
+    __m128i tmp[C];
+    for (int group = C; group > 1; group /= 2) {
+        for (int base = 0; base < C; base += group) {
+            for (int k = 0; k < group / 2; ++k) {
+                SplitEvenOdd<W>(r[base + 2 * k], r[base + 2 * k + 1],
+                                tmp[base + k], tmp[base + group / 2 + k]);
+            }
+        }
+        for (int k = 0; k < C; ++k) {
+            r[k] = tmp[k];
+        }
+    }
+}
+
+template <int W, int C>
+void DeinterleaveSse2(const uint8_t* src, size_t frames, int, int, uint8_t* const* dst) {
+    constexpr size_t kFramesPerIter = 16 / W;
+    constexpr size_t kFrameBytes = static_cast<size_t>(W) * C;
+
+    size_t i = 0;
+    for (; i + kFramesPerIter <= frames; i += kFramesPerIter) {
+        const uint8_t* p = src + i * kFrameBytes;
+        __m128i r[C];
+        for (int k = 0; k < C; ++k) {
+            r[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k));
+        }
+        SplitLevels<W, C>(r);
+        for (int k = 0; k < C; ++k) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst[BitReverse(k, C)] + i * W), r[k]);
+        }
+    }
+
+    // 剩余不足一个寄存器的帧交给标量实现
+    if (i < frames) {
+        uint8_t* tail[C];
+        for (int ch = 0; ch < C; ++ch) {
+            tail[ch] = dst[ch] + i * W;
+        }
+        DeinterleaveScalar(src + i * kFrameBytes, frames - i, W, C, tail);
+    }
+}
+
+template <int W>
+DeinterleaveKernel SelectSse2ByChannels(int num_channels) {
+    switch (num_channels) {
+        case 2: return DeinterleaveSse2<W, 2>;
+        case 4: return DeinterleaveSse2<W, 4>;
+        case 8: return DeinterleaveSse2<W, 8>;
+        default: return nullptr;
+    }
+}
+
+} // namespace
+
+DeinterleaveKernel GetSse2DeinterleaveKernel(int bytes_per_sample, int num_channels) {
+    switch (bytes_per_sample) {
+        case 1: return SelectSse2ByChannels<1>(num_channels);
+        case 2: return SelectSse2ByChannels<2>(num_channels);
+        case 4: return SelectSse2ByChannels<4>(num_channels);
+        default: return nullptr;
+    }
+}
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel level = [] {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int max_leaf = info[0];
+        __cpuid(info, 1);
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        // AVX2还需要操作系统保存YMM寄存器状态
+        if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5)) {
+                return SimdLevel::AVX2;
+            }
+        }
+        return sse2 ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        return __builtin_cpu_supports("sse2") ? SimdLevel::SSE2 : SimdLevel::Scalar;
+#endif
+    }();
+    return level;
+}
+
+#else
+
+DeinterleaveKernel GetSse2DeinterleaveKernel(int, int) {
+    return nullptr;
+}
+
+DeinterleaveKernel GetAvx2DeinterleaveKernel(int, int) {
+    return nullptr;
+}
+
+SimdLevel DetectSimdLevel() {
+    return SimdLevel::Scalar;
+}
+
+#endif
+
+DeinterleaveKernel SelectDeinterleaveKernel(int bytes_per_sample, int num_channels, SimdLevel level) {
+    int index = ChannelOptionIndex(num_channels);
+    if (index >= 0 && bytes_per_sample >= 1 && bytes_per_sample <= kMaxBytesPerSample) {
+        return BuildKernelTable(level).kernels[bytes_per_sample - 1][index];
+    }
+    // 其他布局使用运行时通用实现
+    return DeinterleaveScalar;
+}
+
+DeinterleaveKernel SelectDeinterleaveKernel(int bytes_per_sample, int num_channels) {
+    // 分派表只在首次调用时按当前CPU构建一次
+    static const KernelTable table = BuildKernelTable(DetectSimdLevel());
+    int index = ChannelOptionIndex(num_channels);
+    if (index >= 0 && bytes_per_sample >= 1 && bytes_per_sample <= kMaxBytesPerSample) {
+        return table.kernels[bytes_per_sample - 1][index];
+    }
+    return DeinterleaveScalar;
+}
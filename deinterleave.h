@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 通道分离内核：将src中frames帧交织数据按通道拆分到dst[0..num_channels-1]
+// 专用内核忽略bytes_per_sample和num_channels参数，通用内核依赖它们
+using DeinterleaveKernel = void (*)(const uint8_t* src, size_t frames,
+                                    int bytes_per_sample, int num_channels,
+                                    uint8_t* const* dst);
+
+// CPU支持的SIMD指令集级别
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// 运行时检测CPU支持的SIMD指令集（结果会被缓存）
+SimdLevel DetectSimdLevel();
+
+// 按位深度和通道数从分派表中选择最快的内核，始终返回可用的内核
+DeinterleaveKernel SelectDeinterleaveKernel(int bytes_per_sample, int num_channels);
+
+// 按指定的指令集级别选择内核，不支持的组合回退到标量实现
+DeinterleaveKernel SelectDeinterleaveKernel(int bytes_per_sample, int num_channels, SimdLevel level);
+
+// 标量参考实现，支持任意位深度和通道数
+void DeinterleaveScalar(const uint8_t* src, size_t frames,
+                        int bytes_per_sample, int num_channels,
+                        uint8_t* const* dst);
+
+// 通道抽取：从src的frames帧交织数据中取出channels[0..count-1]指定的通道，按该顺序交织写入dst
+// 只复制选中的通道，count为1时即取出单个通道
+void GatherChannels(const uint8_t* src, size_t frames,
+                    int bytes_per_sample, int num_channels,
+                    const int* channels, int count, uint8_t* dst);
+
+// 编译期特化的标量内核（8/16/24/32位 × 2/4/6/8通道），不支持的组合返回nullptr
+DeinterleaveKernel GetSpecializedDeinterleaveKernel(int bytes_per_sample, int num_channels);
+
+// 各指令集的专用内核，不支持的组合返回nullptr
+DeinterleaveKernel GetSse2DeinterleaveKernel(int bytes_per_sample, int num_channels);
+DeinterleaveKernel GetAvx2DeinterleaveKernel(int bytes_per_sample, int num_channels);
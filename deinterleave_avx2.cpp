@@ -0,0 +1,115 @@
+// AVX2通道分离内核，GCC/Clang需要以-mavx2编译本文件，运行时由DetectSimdLevel决定是否调用
+#include "deinterleave.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+namespace {
+
+constexpr int BitReverse(int index, int count) {
+    int result = 0;
+    for (int bit = 1; bit < count; bit <<= 1) {
+        result = (result << 1) | (index & 1);
+        index >>= 1;
+    }
+    return result;
+}
+
+// 256位指令在两个128位通道内分别打包，结果需要按64位重排成时间顺序
+template <int W>
+inline void SplitEvenOdd(__m256i a, __m256i b, __m256i& even, __m256i& odd);
+
+template <>
+inline void SplitEvenOdd<1>(__m256i a, __m256i b, __m256i& even, __m256i& odd) {
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    even = _mm256_packus_epi16(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask));
+    odd = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+    even = _mm256_permute4x64_epi64(even, _MM_SHUFFLE(3, 1, 2, 0));
+    odd = _mm256_permute4x64_epi64(odd, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template <>
+inline void SplitEvenOdd<2>(__m256i a, __m256i b, __m256i& even, __m256i& odd) {
+    even = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16),
+                              _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16));
+    odd = _mm256_packs_epi32(_mm256_srai_epi32(a, 16), _mm256_srai_epi32(b, 16));
+    even = _mm256_permute4x64_epi64(even, _MM_SHUFFLE(3, 1, 2, 0));
+    odd = _mm256_permute4x64_epi64(odd, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template <>
+inline void SplitEvenOdd<4>(__m256i a, __m256i b, __m256i& even, __m256i& odd) {
+    __m256 fa = _mm256_castsi256_ps(a);
+    __m256 fb = _mm256_castsi256_ps(b);
+    even = _mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+    odd = _mm256_castps_si256(_mm256_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+    even = _mm256_permute4x64_epi64(even, _MM_SHUFFLE(3, 1, 2, 0));
+    odd = _mm256_permute4x64_epi64(odd, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+template <int W, int C>
+inline void SplitLevels(__m256i* r) {
+    __m256i tmp[C];
+    for (int group = C; group > 1; group /= 2) {
+        for (int base = 0; base < C; base += group) {
+            for (int k = 0; k < group / 2; ++k) {
+                SplitEvenOdd<W>(r[base + 2 * k], r[base + 2 * k + 1],
+                                tmp[base + k], tmp[base + group / 2 + k]);
+            }
+        }
+        for (int k = 0; k < C; ++k) {
+            r[k] = tmp[k];
+        }
+    }
+}
+
+template <int W, int C>
+void DeinterleaveAvx2(const uint8_t* src, size_t frames, int, int, uint8_t* const* dst) {
+    constexpr size_t kFramesPerIter = 32 / W;
+    constexpr size_t kFrameBytes = static_cast<size_t>(W) * C;
+
+    size_t i = 0;
+    for (; i + kFramesPerIter <= frames; i += kFramesPerIter) {
+        const uint8_t* p = src + i * kFrameBytes;
+        __m256i r[C];
+        for (int k = 0; k < C; ++k) {
+            r[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * k));
+        }
+        SplitLevels<W, C>(r);
+        for (int k = 0; k < C; ++k) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst[BitReverse(k, C)] + i * W), r[k]);
+        }
+    }
+
+    // 剩余的帧交给SSE2内核（其内部再回退到标量实现）
+    if (i < frames) {
+        uint8_t* tail[C];
+        for (int ch = 0; ch < C; ++ch) {
+            tail[ch] = dst[ch] + i * W;
+        }
+        GetSse2DeinterleaveKernel(W, C)(src + i * kFrameBytes, frames - i, W, C, tail);
+    }
+}
+
+template <int W>
+DeinterleaveKernel SelectAvx2ByChannels(int num_channels) {
+    switch (num_channels) {
+        case 2: return DeinterleaveAvx2<W, 2>;
+        case 4: return DeinterleaveAvx2<W, 4>;
+        case 8: return DeinterleaveAvx2<W, 8>;
+        default: return nullptr;
+    }
+}
+
+} // namespace
+
+DeinterleaveKernel GetAvx2DeinterleaveKernel(int bytes_per_sample, int num_channels) {
+    switch (bytes_per_sample) {
+        case 1: return SelectAvx2ByChannels<1>(num_channels);
+        case 2: return SelectAvx2ByChannels<2>(num_channels);
+        case 4: return SelectAvx2ByChannels<4>(num_channels);
+        default: return nullptr;
+    }
+}
+
+#endif
@@ -0,0 +1,171 @@
+#include "directory_scanner.h"
+#include "riff_reader.h"
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool EqualsIgnoreCase(const std::wstring& a, const std::wstring& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::towlower(static_cast<wint_t>(a[i])) != std::towlower(static_cast<wint_t>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HasWaveHeader(const fs::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    uint8_t header[12];
+    return file.read(reinterpret_cast<char*>(header), sizeof(header)) && IsRiffWaveHeader(header, sizeof(header));
+}
+
+} // namespace
+
+DirectoryScanner::DirectoryScanner(int thread_count, const Options& options, BatchCallback on_batch)
+    : options_(options), on_batch_(std::move(on_batch)) {
+    if (options_.batch_size == 0) {
+        options_.batch_size = 1;
+    }
+    for (int i = 0; i < (thread_count > 0 ? thread_count : 1); ++i) {
+        threads_.emplace_back(&DirectoryScanner::Run, this);
+    }
+}
+
+DirectoryScanner::~DirectoryScanner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        paths_.clear();
+    }
+    work_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void DirectoryScanner::Scan(const std::wstring& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++pending_;
+        paths_.emplace_back(path, true);
+    }
+    work_cv_.notify_one();
+}
+
+void DirectoryScanner::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return pending_ == 0 || stopping_; });
+}
+
+bool DirectoryScanner::Busy() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_ > 0;
+}
+
+void DirectoryScanner::Run() {
+    std::vector<Entry> batch;
+    // 结果还留在batch中的路径数，交付后才从pending_中扣除，保证Wait()返回时结果已全部交付
+    size_t finished = 0;
+    for (;;) {
+        std::pair<std::wstring, bool> item;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (paths_.empty() && finished > 0 && !stopping_) {
+                // 没有更多目录时先交付手中的批次，再进入等待
+                lock.unlock();
+                Deliver(batch, finished);
+                continue;
+            }
+            work_cv_.wait(lock, [this] { return stopping_ || !paths_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            item = std::move(paths_.front());
+            paths_.pop_front();
+        }
+
+        ScanPath(item.first, item.second, batch, finished);
+        ++finished;
+        if (batch.size() >= options_.batch_size) {
+            Deliver(batch, finished);
+        }
+    }
+}
+
+void DirectoryScanner::ScanPath(const std::wstring& path, bool is_root, std::vector<Entry>& batch, size_t& finished) {
+    std::error_code ec;
+    if (is_root && !fs::is_directory(path, ec)) {
+        // 调用方直接添加的文件
+        fs::directory_entry entry(path, ec);
+        if (!ec && entry.is_regular_file(ec) && Accept(entry)) {
+            uint64_t size = entry.file_size(ec);
+            batch.push_back({path, ec ? 0 : size});
+        }
+        return;
+    }
+
+    // 只遍历当前目录，子目录放回队列由空闲线程并行扫描
+    // 与recursive_directory_iterator的默认行为一致，不进入目录符号链接，避免循环
+    fs::directory_iterator it(path, fs::directory_options::skip_permission_denied, ec);
+    for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        const fs::directory_entry& entry = *it;
+        std::error_code entry_ec;
+        if (entry.is_directory(entry_ec)) {
+            if (!entry.is_symlink(entry_ec)) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    ++pending_;
+                    paths_.emplace_back(entry.path().wstring(), false);
+                }
+                work_cv_.notify_one();
+            }
+        } else if (entry.is_regular_file(entry_ec) && Accept(entry)) {
+            uint64_t size = entry.file_size(entry_ec);
+            batch.push_back({entry.path().wstring(), entry_ec ? 0 : size});
+            // 文件很多的目录不必等遍历结束，批次满了就先交付
+            if (batch.size() >= options_.batch_size) {
+                Deliver(batch, finished);
+            }
+        }
+    }
+}
+
+bool DirectoryScanner::Accept(const fs::directory_entry& entry) const {
+    std::wstring extension = entry.path().extension().wstring();
+    bool matched = false;
+    for (const auto& accepted : options_.extensions) {
+        if (EqualsIgnoreCase(extension, accepted)) {
+            matched = true;
+            break;
+        }
+    }
+    if (!matched) {
+        return false;
+    }
+    if (options_.sniff_wav_headers && EqualsIgnoreCase(extension, L".wav")) {
+        return HasWaveHeader(entry.path());
+    }
+    return true;
+}
+
+void DirectoryScanner::Deliver(std::vector<Entry>& batch, size_t& finished) {
+    if (!batch.empty()) {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        on_batch_(batch);
+    }
+    batch.clear();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_ -= finished;
+    finished = 0;
+    if (pending_ == 0) {
+        idle_cv_.notify_all();
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 后台目录扫描：多个线程并行遍历子目录，按扩展名（可选再按文件头）筛选文件，
+// 找到的文件按批次交给回调，调用方不必等整个目录树扫描完成就能开始处理
+class DirectoryScanner {
+public:
+    struct Entry {
+        std::wstring path;
+        uint64_t size = 0;  // 扫描时取得的文件大小，可直接作为调度权重
+    };
+
+    struct Options {
+        std::vector<std::wstring> extensions = {L".wav", L".pcm"};  // 不区分大小写
+        bool sniff_wav_headers = false;  // 对.wav文件检查RIFF/WAVE头，跳过扩展名正确但内容不是WAV的文件
+        size_t batch_size = 256;         // 每批最多的文件数
+    };
+
+    // 回调在扫描线程上调用，同一时刻只有一个回调在执行；回调可以取走batch中的内容
+    using BatchCallback = std::function<void(std::vector<Entry>& batch)>;
+
+    DirectoryScanner(int thread_count, const Options& options, BatchCallback on_batch);
+    // 丢弃尚未扫描的目录并等待扫描线程退出
+    ~DirectoryScanner();
+
+    DirectoryScanner(const DirectoryScanner&) = delete;
+    DirectoryScanner& operator=(const DirectoryScanner&) = delete;
+
+    // 添加扫描路径：目录递归扫描，文件按同样的条件筛选；扫描进行中也可以继续添加
+    void Scan(const std::wstring& path);
+
+    // 等待已添加的路径全部扫描完成、找到的文件全部交给回调
+    void Wait();
+
+    // 是否还有未完成的扫描
+    bool Busy() const;
+
+private:
+    void Run();
+    void ScanPath(const std::wstring& path, bool is_root, std::vector<Entry>& batch, size_t& finished);
+    bool Accept(const std::filesystem::directory_entry& entry) const;
+    void Deliver(std::vector<Entry>& batch, size_t& finished);
+
+    Options options_;
+    BatchCallback on_batch_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::pair<std::wstring, bool>> paths_;  // 待扫描的路径，second表示是否为调用方添加的根路径
+    size_t pending_ = 0;  // 尚未交付结果的路径数（排队中、扫描中或结果还在线程的批次中）
+    bool stopping_ = false;
+
+    std::mutex callback_mutex_;
+    std::vector<std::thread> threads_;
+};
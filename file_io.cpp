@@ -0,0 +1,367 @@
+#include "file_io.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <algorithm>
+#else
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+#endif
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::wstring& file_path) {
+    Close();
+
+    HANDLE file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // 空文件无法创建映射，按已打开的空映射处理
+    if (file_size.QuadPart == 0) {
+        file_handle_ = file;
+        is_open_ = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_handle_ = file;
+    mapping_handle_ = mapping;
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<uint64_t>(file_size.QuadPart);
+    is_open_ = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_handle_) {
+        CloseHandle(mapping_handle_);
+    }
+    if (file_handle_) {
+        CloseHandle(file_handle_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    mapping_handle_ = nullptr;
+    file_handle_ = nullptr;
+    is_open_ = false;
+}
+
+void MappedFile::AdviseSequential(uint64_t, uint64_t) {
+    // Windows在打开文件时已通过FILE_FLAG_SEQUENTIAL_SCAN给出顺序访问提示
+}
+
+RandomAccessFile::RandomAccessFile() = default;
+
+RandomAccessFile::~RandomAccessFile() {
+    Close();
+}
+
+bool RandomAccessFile::Open(const std::wstring& file_path, Mode mode) {
+    Close();
+    DWORD access = mode == Mode::Read ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE;
+    DWORD disposition = mode == Mode::Read ? OPEN_EXISTING : CREATE_ALWAYS;
+    HANDLE file = CreateFileW(file_path.c_str(), access, FILE_SHARE_READ, nullptr,
+                              disposition, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    handle_ = file;
+    return true;
+}
+
+void RandomAccessFile::Close() {
+    if (handle_) {
+        CloseHandle(handle_);
+        handle_ = nullptr;
+    }
+}
+
+bool RandomAccessFile::IsOpen() const {
+    return handle_ != nullptr;
+}
+
+size_t RandomAccessFile::ReadAt(uint64_t offset, void* data, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        // 同步句柄上通过OVERLAPPED指定偏移，多个线程可同时读取
+        OVERLAPPED overlapped = {};
+        uint64_t position = offset + total;
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - total, 1u << 30));
+        DWORD read = 0;
+        if (!ReadFile(handle_, static_cast<uint8_t*>(data) + total, chunk, &read, &overlapped) || read == 0) {
+            break;
+        }
+        total += read;
+    }
+    return total;
+}
+
+bool RandomAccessFile::WriteAt(uint64_t offset, const void* data, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        OVERLAPPED overlapped = {};
+        uint64_t position = offset + total;
+        overlapped.Offset = static_cast<DWORD>(position);
+        overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size - total, 1u << 30));
+        DWORD written = 0;
+        if (!WriteFile(handle_, static_cast<const uint8_t*>(data) + total, chunk, &written, &overlapped) || written == 0) {
+            return false;
+        }
+        total += written;
+    }
+    return true;
+}
+
+bool RandomAccessFile::Resize(uint64_t size) {
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+    return SetFileInformationByHandle(handle_, FileEndOfFileInfo, &info, sizeof(info)) != FALSE;
+}
+
+bool RandomAccessFile::CopyFrom(RandomAccessFile&, uint64_t, uint64_t, uint64_t, uint64_t& copied) {
+    // Windows没有通用的按偏移在两个文件之间复制的内核接口（块克隆只支持ReFS），由调用方读写
+    copied = 0;
+    return false;
+}
+
+#else
+
+const char* Utf8Path(const std::wstring& path) {
+    // 容量只增不减，常见长度的路径不会再分配
+    thread_local std::string buffer;
+    if (buffer.capacity() < 1024) {
+        buffer.reserve(1024);
+    }
+    buffer.clear();
+    for (wchar_t wc : path) {
+        uint32_t c = static_cast<uint32_t>(wc);
+        if (c < 0x80) {
+            buffer += static_cast<char>(c);
+        } else if (c < 0x800) {
+            buffer += static_cast<char>(0xC0 | (c >> 6));
+            buffer += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            buffer += static_cast<char>(0xE0 | (c >> 12));
+            buffer += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            buffer += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+            buffer += static_cast<char>(0xF0 | (c >> 18));
+            buffer += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+            buffer += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+            buffer += static_cast<char>(0x80 | (c & 0x3F));
+        }
+    }
+    return buffer.c_str();
+}
+
+bool MappedFile::Open(const std::wstring& file_path) {
+    Close();
+
+    int fd = open(Utf8Path(file_path), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // 空文件无法创建映射，按已打开的空映射处理
+    if (st.st_size == 0) {
+        fd_ = fd;
+        is_open_ = true;
+        return true;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    data_ = static_cast<const uint8_t*>(view);
+    size_ = static_cast<uint64_t>(st.st_size);
+    is_open_ = true;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), static_cast<size_t>(size_));
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+    is_open_ = false;
+}
+
+void MappedFile::AdviseSequential(uint64_t offset, uint64_t length) {
+    if (!data_ || offset >= size_) {
+        return;
+    }
+    // madvise要求起始地址按页对齐
+    uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t aligned = offset - offset % page_size;
+    uint64_t end = std::min(offset + length, size_);
+    madvise(const_cast<uint8_t*>(data_) + aligned, static_cast<size_t>(end - aligned), MADV_SEQUENTIAL);
+    posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(end - offset), POSIX_FADV_SEQUENTIAL);
+}
+
+RandomAccessFile::RandomAccessFile() = default;
+
+RandomAccessFile::~RandomAccessFile() {
+    Close();
+}
+
+bool RandomAccessFile::Open(const std::wstring& file_path, Mode mode) {
+    Close();
+    int flags = mode == Mode::Read ? O_RDONLY : O_RDWR | O_CREAT | O_TRUNC;
+    fd_ = open(Utf8Path(file_path), flags, 0644);
+    return fd_ >= 0;
+}
+
+void RandomAccessFile::Close() {
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool RandomAccessFile::IsOpen() const {
+    return fd_ >= 0;
+}
+
+size_t RandomAccessFile::ReadAt(uint64_t offset, void* data, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t read = pread(fd_, static_cast<uint8_t*>(data) + total, size - total,
+                             static_cast<off_t>(offset + total));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(read);
+    }
+    return total;
+}
+
+bool RandomAccessFile::WriteAt(uint64_t offset, const void* data, size_t size) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t written = pwrite(fd_, static_cast<const uint8_t*>(data) + total, size - total,
+                                 static_cast<off_t>(offset + total));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        total += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool RandomAccessFile::Resize(uint64_t size) {
+    return ftruncate(fd_, static_cast<off_t>(size)) == 0;
+}
+
+bool RandomAccessFile::CopyFrom(RandomAccessFile& source, uint64_t source_offset, uint64_t offset, uint64_t size,
+                                uint64_t& copied) {
+    copied = 0;
+#ifdef __linux__
+    // 优先使用copy_file_range（同一文件系统上可能直接共享数据块），
+    // 内核或文件系统不支持时改用sendfile，两者都在内核中完成复制
+    off_t in_offset = static_cast<off_t>(source_offset);
+    off_t out_offset = static_cast<off_t>(offset);
+    bool use_sendfile = false;
+    while (copied < size) {
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(size - copied, 1u << 30));
+        ssize_t result;
+        if (!use_sendfile) {
+            result = copy_file_range(source.fd_, &in_offset, fd_, &out_offset, chunk, 0);
+            if (result < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP)) {
+                use_sendfile = true;
+                continue;
+            }
+        } else {
+            // sendfile写到输出文件的当前位置，先定位到目标偏移
+            if (lseek(fd_, out_offset, SEEK_SET) < 0) {
+                return false;
+            }
+            result = sendfile(fd_, source.fd_, &in_offset, chunk);
+            if (result > 0) {
+                out_offset += result;
+            }
+        }
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0) {
+            return false;
+        }
+        if (result == 0) {
+            break;
+        }
+        copied += static_cast<uint64_t>(result);
+    }
+    return true;
+#else
+    (void)source;
+    (void)source_offset;
+    (void)offset;
+    (void)size;
+    return false;
+#endif
+}
+
+#endif
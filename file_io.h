@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef _WIN32
+// 把宽字符路径按UTF-8编码为系统调用使用的路径，与std::filesystem::path的转换结果相同
+// 结果位于线程内复用的缓冲区，在同一线程下一次调用之前有效，稳定状态下不分配内存
+const char* Utf8Path(const std::wstring& path);
+#endif
+
+// 只读内存映射文件，Windows使用CreateFileMapping，其他平台使用mmap
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射整个文件，失败时返回false（例如32位进程无法映射超大文件）
+    bool Open(const std::wstring& file_path);
+
+    // 解除映射并关闭文件
+    void Close();
+
+    bool IsOpen() const { return is_open_; }
+    const uint8_t* Data() const { return data_; }
+    uint64_t Size() const { return size_; }
+
+    // 提示系统将按顺序访问[offset, offset + length)，以便提前预读
+    void AdviseSequential(uint64_t offset, uint64_t length);
+
+private:
+    const uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+    bool is_open_ = false;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
+
+// 支持按偏移读写的文件（pread/pwrite语义），多个线程可共用同一实例读写不同区域
+class RandomAccessFile {
+public:
+    // 打开方式
+    enum class Mode {
+        Read,       // 只读打开已有文件
+        Create      // 创建或清空文件，可读写
+    };
+
+    RandomAccessFile();
+    ~RandomAccessFile();
+
+    RandomAccessFile(const RandomAccessFile&) = delete;
+    RandomAccessFile& operator=(const RandomAccessFile&) = delete;
+
+    bool Open(const std::wstring& file_path, Mode mode);
+    void Close();
+    bool IsOpen() const;
+
+    // 从offset处读取最多size字节，返回实际读取的字节数（到达文件末尾时小于size）
+    size_t ReadAt(uint64_t offset, void* data, size_t size);
+
+    // 在offset处写入size字节，全部写入成功时返回true
+    bool WriteAt(uint64_t offset, const void* data, size_t size);
+
+    // 设置文件长度
+    bool Resize(uint64_t size);
+
+    // 由内核把source中[source_offset, source_offset + size)的数据复制到本文件的offset处，数据不经过用户空间
+    // copied返回实际复制的字节数，source先到达文件末尾时小于size
+    // 系统不支持内核复制（如非Linux平台、文件系统不支持）或复制出错时返回false，调用方改为自行读写
+    bool CopyFrom(RandomAccessFile& source, uint64_t source_offset, uint64_t offset, uint64_t size, uint64_t& copied);
+
+private:
+#ifdef _WIN32
+    void* handle_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
@@ -0,0 +1,75 @@
+#include "file_list.h"
+#include <cstdint>
+#include <cwctype>
+#include <utility>
+
+namespace {
+
+wchar_t FoldCase(wchar_t c) {
+    // ASCII部分直接转换，其余字符交给towlower
+    if (c < 0x80) {
+        return (c >= L'A' && c <= L'Z') ? static_cast<wchar_t>(c + (L'a' - L'A')) : c;
+    }
+    return static_cast<wchar_t>(std::towlower(static_cast<wint_t>(c)));
+}
+
+} // namespace
+
+size_t FileList::CaseInsensitiveHash::operator()(const std::wstring& text) const {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (wchar_t c : text) {
+        hash ^= static_cast<uint64_t>(FoldCase(c));
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool FileList::CaseInsensitiveEqual::operator()(const std::wstring& a, const std::wstring& b) const {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (FoldCase(a[i]) != FoldCase(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FileList::Add(const std::wstring& path) {
+    if (!index_.insert(path).second) {
+        return false;
+    }
+    paths_.push_back(path);
+    return true;
+}
+
+void FileList::Remove(const std::vector<size_t>& indices) {
+    std::vector<bool> removed(paths_.size(), false);
+    for (size_t index : indices) {
+        if (index < paths_.size() && !removed[index]) {
+            removed[index] = true;
+            index_.erase(paths_[index]);
+        }
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        if (!removed[i]) {
+            if (kept != i) {
+                paths_[kept] = std::move(paths_[i]);
+            }
+            ++kept;
+        }
+    }
+    paths_.resize(kept);
+}
+
+void FileList::Clear() {
+    paths_.clear();
+    index_.clear();
+}
+
+bool FileList::Contains(const std::wstring& path) const {
+    return index_.find(path) != index_.end();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// 待处理文件列表：按导入顺序保存路径，并用不区分大小写的哈希索引去重，
+// 导入和查重都是O(1)，导入大量文件时总耗时与文件数成线性关系
+// 列表下标即文件编号，随任务一起传给工作线程，用于定位列表行和进度槽位
+class FileList {
+public:
+    // 添加文件，路径（不区分大小写）已存在时返回false
+    bool Add(const std::wstring& path);
+
+    // 删除多个下标的文件（顺序任意），一次遍历完成，剩余文件保持原有顺序
+    void Remove(const std::vector<size_t>& indices);
+
+    void Clear();
+
+    bool Contains(const std::wstring& path) const;
+
+    size_t Size() const { return paths_.size(); }
+    bool Empty() const { return paths_.empty(); }
+    const std::wstring& operator[](size_t index) const { return paths_[index]; }
+
+    std::vector<std::wstring>::const_iterator begin() const { return paths_.begin(); }
+    std::vector<std::wstring>::const_iterator end() const { return paths_.end(); }
+
+private:
+    // 按小写字符计算哈希和比较，不需要为每个路径生成小写副本
+    struct CaseInsensitiveHash {
+        size_t operator()(const std::wstring& text) const;
+    };
+    struct CaseInsensitiveEqual {
+        bool operator()(const std::wstring& a, const std::wstring& b) const;
+    };
+
+    std::vector<std::wstring> paths_;
+    std::unordered_set<std::wstring, CaseInsensitiveHash, CaseInsensitiveEqual> index_;
+};
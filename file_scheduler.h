@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 文件任务调度器：每个工作线程一个双端队列，空闲线程从其他队列窃取任务
+// 任务按文件大小降序分配，大文件优先开始处理，避免批次末尾单线程处理大文件
+template <typename Task>
+class FileScheduler {
+public:
+    struct Item {
+        Task task;
+        uint64_t size = 0;  // 文件大小，作为调度权重
+    };
+
+    // 清空所有队列并按工作线程数重建
+    void Start(int worker_count) {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        queues_.clear();
+        for (int i = 0; i < (std::max)(1, worker_count); ++i) {
+            queues_.push_back(std::make_unique<WorkerQueue>());
+        }
+        pending_ = 0;
+        closed_ = false;
+        shutdown_ = false;
+    }
+
+    // 批量提交任务：按大小降序，依次分配给已分配字节数最少的队列
+    void Submit(std::vector<Item> items) {
+        if (queues_.empty()) {
+            return;
+        }
+        std::stable_sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+            return a.size > b.size;
+        });
+        // 先增加计数再入队，保证取走任务时计数不会下溢
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            pending_ += items.size();
+        }
+        for (auto& item : items) {
+            WorkerQueue* target = queues_.front().get();
+            for (auto& queue : queues_) {
+                if (queue->bytes.load() < target->bytes.load()) {
+                    target = queue.get();
+                }
+            }
+            std::lock_guard<std::mutex> lock(target->mutex);
+            target->bytes += item.size;
+            target->items.push_back(std::move(item));
+        }
+        wait_cv_.notify_all();
+    }
+
+    // 不再提交新任务，队列处理完后工作线程退出
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            closed_ = true;
+        }
+        wait_cv_.notify_all();
+    }
+
+    // 立即停止，未处理的任务被丢弃
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(wait_mutex_);
+            shutdown_ = true;
+        }
+        wait_cv_.notify_all();
+        for (auto& queue : queues_) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->items.clear();
+            queue->bytes = 0;
+        }
+    }
+
+    // 获取下一个任务：先取自己队列中最大的任务，为空时从剩余字节最多的队列窃取
+    // 没有任务时等待，调度器关闭且任务处理完后返回false
+    bool Next(int worker, Task& task) {
+        for (;;) {
+            if (shutdown_) {
+                return false;
+            }
+            if (TryPop(worker, task) || TrySteal(worker, task)) {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            wait_cv_.wait(lock, [this] { return pending_ > 0 || closed_ || shutdown_; });
+            if (shutdown_ || (closed_ && pending_ == 0)) {
+                return false;
+            }
+        }
+    }
+
+    // 尚未被取走的任务数
+    size_t Pending() const {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        return pending_;
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Item> items;        // 按大小降序
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    bool TakeFront(WorkerQueue& queue, Task& task) {
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.items.empty()) {
+                return false;
+            }
+            task = std::move(queue.items.front().task);
+            queue.bytes -= queue.items.front().size;
+            queue.items.pop_front();
+        }
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        --pending_;
+        return true;
+    }
+
+    bool TryPop(int worker, Task& task) {
+        if (worker < 0 || worker >= static_cast<int>(queues_.size())) {
+            return false;
+        }
+        return TakeFront(*queues_[worker], task);
+    }
+
+    // 窃取剩余字节最多的队列中最大的任务，保持全局大文件优先
+    bool TrySteal(int worker, Task& task) {
+        for (;;) {
+            WorkerQueue* victim = nullptr;
+            uint64_t victim_bytes = 0;
+            for (int i = 0; i < static_cast<int>(queues_.size()); ++i) {
+                if (i == worker) {
+                    continue;
+                }
+                std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+                if (!queues_[i]->items.empty() &&
+                    (!victim || queues_[i]->bytes.load() > victim_bytes)) {
+                    victim = queues_[i].get();
+                    victim_bytes = queues_[i]->bytes.load();
+                }
+            }
+            if (!victim) {
+                return false;
+            }
+            // 选中后可能已被其他线程取空，重新选择
+            if (TakeFront(*victim, task)) {
+                return true;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    mutable std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+    size_t pending_ = 0;
+    bool closed_ = false;
+    std::atomic<bool> shutdown_{false};
+};
@@ -0,0 +1,90 @@
+#include "progress_registry.h"
+
+void ProgressRegistry::Reset(size_t count) {
+    count_.store(0, std::memory_order_relaxed);
+    weighted_sum_.store(0, std::memory_order_relaxed);
+    total_weight_.store(0, std::memory_order_relaxed);
+    Grow(count);
+}
+
+void ProgressRegistry::Grow(size_t count) {
+    size_t current = count_.load(std::memory_order_relaxed);
+    if (count > kSegmentSize * kMaxSegments) {
+        count = kSegmentSize * kMaxSegments;
+    }
+    if (count <= current) {
+        return;
+    }
+    if (!segments_) {
+        segments_.reset(new std::unique_ptr<Entry[]>[kMaxSegments]);
+    }
+    while (segment_count_ * kSegmentSize < count) {
+        segments_[segment_count_++].reset(new Entry[kSegmentSize]);
+    }
+    // 段在批次之间复用，新增的槽位可能留有上一批的值
+    for (size_t id = current; id < count; ++id) {
+        Slot(id).value.store(0, std::memory_order_relaxed);
+        Slot(id).weight.store(1, std::memory_order_relaxed);
+    }
+    total_weight_.fetch_add(count - current, std::memory_order_relaxed);
+    count_.store(count, std::memory_order_release);
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+void ProgressRegistry::SetWeight(size_t id, uint64_t weight) {
+    if (id >= count_.load(std::memory_order_acquire)) {
+        return;
+    }
+    if (weight == 0) {
+        weight = 1;
+    }
+    Entry& entry = Slot(id);
+    uint64_t previous = entry.weight.exchange(weight, std::memory_order_relaxed);
+    if (previous == weight) {
+        return;
+    }
+    // 无符号数按模运算，减少时加上差值的补码即可
+    uint64_t percent = static_cast<uint64_t>(Percent(entry.value.load(std::memory_order_relaxed)));
+    total_weight_.fetch_add(weight - previous, std::memory_order_relaxed);
+    weighted_sum_.fetch_add(percent * (weight - previous), std::memory_order_relaxed);
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+void ProgressRegistry::Set(size_t id, int value) {
+    if (id >= count_.load(std::memory_order_acquire)) {
+        return;
+    }
+    Entry& entry = Slot(id);
+    int previous = entry.value.exchange(value, std::memory_order_relaxed);
+    if (previous == value) {
+        return;
+    }
+    uint64_t weight = entry.weight.load(std::memory_order_relaxed);
+    weighted_sum_.fetch_add(static_cast<uint64_t>(static_cast<int64_t>(Percent(value) - Percent(previous))) * weight,
+                            std::memory_order_relaxed);
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+int ProgressRegistry::Get(size_t id) const {
+    return id < count_.load(std::memory_order_acquire) ? Slot(id).value.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t ProgressRegistry::Snapshot(std::vector<int>& values) const {
+    // 先取版本号再复制，复制期间的写入会使下一次Version()不同，不会漏掉
+    uint64_t version = version_.load(std::memory_order_acquire);
+    size_t count = count_.load(std::memory_order_acquire);
+    values.resize(count);
+    for (size_t id = 0; id < count; ++id) {
+        values[id] = Slot(id).value.load(std::memory_order_relaxed);
+    }
+    return version;
+}
+
+int ProgressRegistry::OverallPercent() const {
+    uint64_t total = total_weight_.load(std::memory_order_relaxed);
+    if (count_.load(std::memory_order_acquire) == 0 || total == 0) {
+        return 0;
+    }
+    uint64_t percent = weighted_sum_.load(std::memory_order_relaxed) / total;
+    return percent > 100 ? 100 : static_cast<int>(percent);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 批量处理的逐文件进度表：每个文件一个原子槽位，按文件编号索引
+// 工作线程无锁写入（不分配内存、不等待），界面定时器或命令行按需取快照
+// 槽位分段分配，边扫描边处理时可以随文件数增长，已有槽位的地址不变
+class ProgressRegistry {
+public:
+    // 槽位的取值：0~100为进度百分比，负值为失败状态（计入总进度时按100%计算）
+    static const int kLoadFailed = -1;
+    static const int kSplitFailed = -2;
+
+    // 按文件数重新分配槽位并全部置为0，必须在工作线程开始写入之前调用
+    void Reset(size_t count);
+
+    // 把文件数增加到count，新槽位置为0、权重置为1；可以与Set()和Snapshot()同时进行，但只能由一个线程调用
+    void Grow(size_t count);
+
+    // 设置文件在总进度中的权重（如data块字节数，0按1计算），默认各文件权重相同
+    // 应在该文件开始处理之前由调用Grow()的线程设置，id超出范围时忽略
+    void SetWeight(size_t id, uint64_t weight);
+
+    size_t Size() const { return count_.load(std::memory_order_acquire); }
+
+    // 写入文件进度，id超出范围时忽略
+    void Set(size_t id, int value);
+    int Get(size_t id) const;
+
+    // 每次写入都会递增版本号，版本号不变时说明没有新的进度
+    uint64_t Version() const { return version_.load(std::memory_order_acquire); }
+
+    // 把全部槽位复制到values（复用其容量），返回复制前的版本号
+    uint64_t Snapshot(std::vector<int>& values) const;
+
+    // 所有文件按权重的平均进度，0~100
+    int OverallPercent() const;
+
+private:
+    static const size_t kSegmentSize = 4096;
+    static const size_t kMaxSegments = 4096;  // 最多约1600万个文件
+
+    struct Entry {
+        std::atomic<int> value;
+        std::atomic<uint64_t> weight;
+    };
+
+    static int Percent(int value) { return value < 0 ? 100 : value; }
+    Entry& Slot(size_t id) const { return segments_[id / kSegmentSize][id % kSegmentSize]; }
+
+    // 段指针表在第一次使用时一次分配，之后只追加段，不会移动已有槽位
+    std::unique_ptr<std::unique_ptr<Entry[]>[]> segments_;
+    size_t segment_count_ = 0;
+    std::atomic<size_t> count_{0};
+    // 各槽位百分比乘以权重之和及权重之和，写入时按差值更新，计算总进度不必遍历槽位
+    std::atomic<uint64_t> weighted_sum_{0};
+    std::atomic<uint64_t> total_weight_{0};
+    std::atomic<uint64_t> version_{0};
+};
@@ -0,0 +1,176 @@
+#include "resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define RESAMPLER_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 约分后up和down的上限，超过时系数表过大（如44100与44101之间的转换）
+const int kMaxPhases = 4096;
+
+// 滤波器在较低采样率下每侧的过零点数，决定过渡带宽度
+const int kZeroCrossings = 24;
+
+// 截止频率相对于较低奈奎斯特频率的比例，过渡带落在截止频率和奈奎斯特频率之间
+const double kCutoff = 0.9;
+
+// Kaiser窗参数，阻带衰减约90 dB
+const double kKaiserBeta = 9.0;
+
+const double kPi = 3.14159265358979323846;
+
+// 第一类零阶修正贝塞尔函数，级数展开
+double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+float DotProduct(const float* a, const float* b, int count) {
+    int i = 0;
+#ifdef RESAMPLER_X86
+    // count为4的倍数，用两个累加器减少加法的依赖链
+    __m128 sum0 = _mm_setzero_ps();
+    __m128 sum1 = _mm_setzero_ps();
+    for (; i + 8 <= count; i += 8) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i + 4 <= count; i += 4) {
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    sum0 = _mm_add_ps(sum0, sum1);
+    sum0 = _mm_add_ps(sum0, _mm_movehl_ps(sum0, sum0));
+    sum0 = _mm_add_ss(sum0, _mm_shuffle_ps(sum0, sum0, 1));
+    float sum = _mm_cvtss_f32(sum0);
+#else
+    float sum = 0.0f;
+#endif
+    for (; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+} // namespace
+
+bool PolyphaseFilter::Design(uint32_t input_rate, uint32_t output_rate) {
+    if (input_rate == 0 || output_rate == 0) {
+        return false;
+    }
+    if (input_rate == input_rate_ && output_rate == output_rate_) {
+        return true;
+    }
+    uint32_t divisor = std::gcd(input_rate, output_rate);
+    if (output_rate / divisor > static_cast<uint32_t>(kMaxPhases) ||
+        input_rate / divisor > static_cast<uint32_t>(kMaxPhases)) {
+        return false;
+    }
+    up_ = static_cast<int>(output_rate / divisor);
+    down_ = static_cast<int>(input_rate / divisor);
+
+    // 以输入采样间隔为单位设计：降采样时截止频率按比例降低，滤波器相应加长
+    double scale = std::min(1.0, static_cast<double>(up_) / down_);
+    double cutoff = kCutoff * scale;
+    int half = static_cast<int>(std::ceil(kZeroCrossings / scale));
+    delay_ = half - 1;
+    taps_ = (2 * half + 3) / 4 * 4;
+
+    // 第p个相位对应的输出时刻在输入位置index + p / up处，
+    // 第j个系数作用于输入位置index - delay + j，两者的距离为j - delay - p / up
+    coefficients_.assign(static_cast<size_t>(up_) * taps_, 0.0f);
+    double window_norm = BesselI0(kKaiserBeta);
+    for (int p = 0; p < up_; ++p) {
+        float* phase = coefficients_.data() + static_cast<size_t>(p) * taps_;
+        double sum = 0.0;
+        for (int j = 0; j < 2 * half; ++j) {
+            double d = j - delay_ - static_cast<double>(p) / up_;
+            double r = d / half;
+            if (r <= -1.0 || r >= 1.0) {
+                continue;
+            }
+            double x = cutoff * d;
+            double sinc = x == 0.0 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+            double window = BesselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) / window_norm;
+            double value = cutoff * sinc * window;
+            phase[j] = static_cast<float>(value);
+            sum += value;
+        }
+        // 每个相位单独归一化，直流增益为1，不会因相位不同产生周期性的幅度起伏
+        for (int j = 0; j < taps_; ++j) {
+            phase[j] = static_cast<float>(phase[j] / sum);
+        }
+    }
+    input_rate_ = input_rate;
+    output_rate_ = output_rate;
+    return true;
+}
+
+uint64_t PolyphaseFilter::OutputFrames(uint64_t input_frames) const {
+    return (input_frames * up_ + down_ - 1) / down_;
+}
+
+void ChannelResampler::Reset(const PolyphaseFilter* filter) {
+    filter_ = filter;
+    // 第一个输出需要位置0之前的delay个样本，按零处理
+    history_.assign(filter_->Delay(), 0.0f);
+    history_start_ = -filter_->Delay();
+    input_count_ = 0;
+    output_count_ = 0;
+    next_index_ = 0;
+    next_phase_ = 0;
+}
+
+size_t ChannelResampler::Process(const float* in, size_t count, float* out) {
+    history_.insert(history_.end(), in, in + count);
+    input_count_ += count;
+    return Drain(out, UINT64_MAX);
+}
+
+size_t ChannelResampler::Finish(float* out) {
+    // 补零到最后一个输出需要的位置，补的零不计入输入样本数
+    history_.insert(history_.end(), filter_->Taps(), 0.0f);
+    return Drain(out, filter_->OutputFrames(input_count_));
+}
+
+size_t ChannelResampler::MaxOutput(size_t count) const {
+    return static_cast<size_t>((static_cast<uint64_t>(count) + filter_->Taps()) * filter_->Up() / filter_->Down() + 1);
+}
+
+size_t ChannelResampler::Drain(float* out, uint64_t limit) {
+    const int taps = filter_->Taps();
+    const int delay = filter_->Delay();
+    const int up = filter_->Up();
+    const int down = filter_->Down();
+    int64_t history_end = history_start_ + static_cast<int64_t>(history_.size());
+
+    size_t produced = 0;
+    while (output_count_ < limit && next_index_ - delay + taps <= history_end) {
+        const float* samples = history_.data() + (next_index_ - delay - history_start_);
+        out[produced++] = DotProduct(filter_->Phase(next_phase_), samples, taps);
+        ++output_count_;
+        next_phase_ += down;
+        next_index_ += next_phase_ / up;
+        next_phase_ %= up;
+    }
+
+    // 丢弃之后的输出不再需要的样本，历史缓冲区的长度保持在一块输入加一个滤波器长度以内
+    int64_t keep_from = std::min(next_index_ - delay, history_end);
+    if (keep_from > history_start_) {
+        history_.erase(history_.begin(), history_.begin() + (keep_from - history_start_));
+        history_start_ = keep_from;
+    }
+    return produced;
+}
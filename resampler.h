@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 有理数比例（output_rate / input_rate约分为up / down）的多相FIR重采样滤波器，
+// 系数为Kaiser窗sinc，截止频率取两个采样率中较低者的奈奎斯特频率，可由多个通道共用
+class PolyphaseFilter {
+public:
+    // 按输入输出采样率设计滤波器，采样率为0或约分后的相位数过多时返回false
+    // 已按相同的采样率设计过时直接返回，同一个对象处理多个文件时系数表只计算一次
+    bool Design(uint32_t input_rate, uint32_t output_rate);
+
+    int Up() const { return up_; }
+    int Down() const { return down_; }
+
+    // 每个相位的抽头数（已补齐到4的倍数），以及输出样本对应时刻之前需要的输入样本数
+    int Taps() const { return taps_; }
+    int Delay() const { return delay_; }
+
+    // 第phase个相位的系数，与连续的Taps()个输入样本做点积
+    const float* Phase(int phase) const { return coefficients_.data() + static_cast<size_t>(phase) * taps_; }
+
+    // input_frames帧输入对应的输出帧数，即ceil(input_frames * up / down)
+    uint64_t OutputFrames(uint64_t input_frames) const;
+
+private:
+    uint32_t input_rate_ = 0;
+    uint32_t output_rate_ = 0;
+    int up_ = 1;
+    int down_ = 1;
+    int taps_ = 0;
+    int delay_ = 0;
+    std::vector<float> coefficients_;
+};
+
+// 单个通道的重采样状态：按块输入时保留滤波器需要的历史样本和当前相位，
+// 分块处理的结果与整段一次处理完全相同
+class ChannelResampler {
+public:
+    // 开始新的一段输入，filter在使用期间必须保持有效
+    void Reset(const PolyphaseFilter* filter);
+
+    // 输入count个样本，把能够计算的输出写入out，返回输出的样本数
+    // out至少要有MaxOutput(count)个样本的空间
+    size_t Process(const float* in, size_t count, float* out);
+
+    // 输入结束，在末尾补零算出剩余的输出，使总输出帧数等于filter->OutputFrames(总输入帧数)
+    // out至少要有MaxOutput(0)个样本的空间
+    size_t Finish(float* out);
+
+    // 输入count个样本（含Finish时补的零）最多产生的输出样本数
+    size_t MaxOutput(size_t count) const;
+
+private:
+    // 用history_中已有的样本计算输出，直到下一个输出需要尚未到达的样本
+    size_t Drain(float* out, uint64_t limit);
+
+    const PolyphaseFilter* filter_ = nullptr;
+    std::vector<float> history_;    // 输入样本，history_[0]对应绝对位置history_start_
+    int64_t history_start_ = 0;
+    uint64_t input_count_ = 0;      // 已输入的样本数
+    uint64_t output_count_ = 0;     // 已输出的样本数
+    int64_t next_index_ = 0;        // 下一个输出对应的输入位置floor(n * down / up)
+    int next_phase_ = 0;            // 下一个输出的相位(n * down) % up
+};
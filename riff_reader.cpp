@@ -0,0 +1,112 @@
+#include "riff_reader.h"
+#include <cstring>
+
+namespace {
+
+uint16_t ReadLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t ReadLe32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint64_t ReadLe64(const uint8_t* p) {
+    return static_cast<uint64_t>(ReadLe32(p)) | (static_cast<uint64_t>(ReadLe32(p + 4)) << 32);
+}
+
+// RF64中大小字段为该值时，实际大小记录在ds64块中
+const uint32_t kRf64SizePlaceholder = 0xFFFFFFFF;
+
+// 解析fmt块内容，size至少为16字节
+bool ParseFormatChunk(const uint8_t* fmt, uint32_t size, RiffLayout& layout) {
+    if (size < 16) {
+        return false;
+    }
+    layout.format_tag = ReadLe16(fmt);
+    layout.num_channels = ReadLe16(fmt + 2);
+    layout.sample_rate = ReadLe32(fmt + 4);
+    layout.byte_rate = ReadLe32(fmt + 8);
+    layout.block_align = ReadLe16(fmt + 12);
+    layout.bits_per_sample = ReadLe16(fmt + 14);
+    layout.sub_format = layout.format_tag;
+    layout.valid_bits = layout.bits_per_sample;
+    layout.channel_mask = 0;
+
+    // WAVEFORMATEXTENSIBLE: cbSize(2) + wValidBitsPerSample(2) + dwChannelMask(4) + SubFormat(16)
+    if (layout.format_tag == kWaveFormatExtensible) {
+        if (size < 40 || ReadLe16(fmt + 16) < 22) {
+            return false;
+        }
+        uint16_t valid_bits = ReadLe16(fmt + 18);
+        layout.valid_bits = valid_bits != 0 ? valid_bits : layout.bits_per_sample;
+        layout.channel_mask = ReadLe32(fmt + 20);
+        // SubFormat GUID的前两个字节即格式标签
+        layout.sub_format = ReadLe16(fmt + 24);
+    }
+    return layout.num_channels > 0 && layout.bits_per_sample > 0;
+}
+
+} // namespace
+
+bool IsRiffWaveHeader(const uint8_t* header, size_t size) {
+    if (size < 12 || std::memcmp(header + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    return std::memcmp(header, "RIFF", 4) == 0 || std::memcmp(header, "RF64", 4) == 0 ||
+           std::memcmp(header, "BW64", 4) == 0;
+}
+
+bool ReadRiffLayout(std::istream& file, RiffLayout& layout) {
+    uint8_t riff[12];
+    if (!file.read(reinterpret_cast<char*>(riff), sizeof(riff)) || !IsRiffWaveHeader(riff, sizeof(riff))) {
+        return false;
+    }
+    layout.rf64 = std::memcmp(riff, "RIFF", 4) != 0;
+
+    uint64_t ds64_data_size = 0;
+    bool has_ds64 = false;
+    bool has_format = false;
+    bool has_data = false;
+    uint64_t position = sizeof(riff);
+    while (!(has_format && has_data)) {
+        uint8_t chunk[8];
+        if (!file.read(reinterpret_cast<char*>(chunk), sizeof(chunk))) {
+            return false;
+        }
+        uint64_t size = ReadLe32(chunk + 4);
+        position += sizeof(chunk);
+
+        if (std::memcmp(chunk, "ds64", 4) == 0) {
+            // ds64: riffSize(8) + dataSize(8) + sampleCount(8) + tableLength(4) + table
+            uint8_t ds64[24];
+            if (size < sizeof(ds64) || !file.read(reinterpret_cast<char*>(ds64), sizeof(ds64))) {
+                return false;
+            }
+            ds64_data_size = ReadLe64(ds64 + 8);
+            has_ds64 = true;
+        } else if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            // 只需要前40字节（WAVEFORMATEXTENSIBLE的长度），其余部分跳过
+            uint8_t fmt[40] = {};
+            uint32_t read_size = size < sizeof(fmt) ? static_cast<uint32_t>(size) : static_cast<uint32_t>(sizeof(fmt));
+            if (!file.read(reinterpret_cast<char*>(fmt), read_size) ||
+                !ParseFormatChunk(fmt, read_size, layout)) {
+                return false;
+            }
+            has_format = true;
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (layout.rf64 && has_ds64 && size == kRf64SizePlaceholder) {
+                size = ds64_data_size;
+            }
+            layout.data_offset = position;
+            layout.data_size = size;
+            has_data = true;
+        }
+
+        // RIFF块按偶数字节对齐，奇数长度的块后面有一个填充字节
+        position += size + (size & 1);
+        file.seekg(static_cast<std::streamoff>(position));
+    }
+    return true;
+}
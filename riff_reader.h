@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+
+// WAV格式标签
+const uint16_t kWaveFormatPcm = 0x0001;
+const uint16_t kWaveFormatIeeeFloat = 0x0003;
+const uint16_t kWaveFormatExtensible = 0xFFFE;
+
+// 从RIFF/WAVE文件中解析出的格式信息和data块位置
+struct RiffLayout {
+    bool rf64 = false;                      // RF64/BW64文件，块大小以ds64块中的64位值为准
+    uint16_t format_tag = kWaveFormatPcm;   // fmt块中的格式标签
+    uint16_t sub_format = kWaveFormatPcm;   // 实际样本格式，EXTENSIBLE时取自SubFormat GUID
+    uint16_t num_channels = 0;
+    uint32_t sample_rate = 0;
+    uint32_t byte_rate = 0;
+    uint16_t block_align = 0;
+    uint16_t bits_per_sample = 0;
+    uint16_t valid_bits = 0;                // EXTENSIBLE中的有效位数，否则与bits_per_sample相同
+    uint32_t channel_mask = 0;              // EXTENSIBLE中的声道掩码，否则为0
+    uint64_t data_offset = 0;               // data块内容在文件中的偏移
+    uint64_t data_size = 0;                 // data块大小
+};
+
+// 逐块遍历RIFF/WAVE文件，在任意位置找到fmt和data块，跳过LIST、JUNK、fact、bext等其他块
+// 同时支持RF64/BW64文件，从ds64块读取超过4GB的data块大小
+// file需位于文件开头，成功时file位置未定义
+bool ReadRiffLayout(std::istream& file, RiffLayout& layout);
+
+// 检查文件开头的12字节是否为RIFF/RF64/BW64 WAVE文件头，用于导入时按内容筛选文件
+bool IsRiffWaveHeader(const uint8_t* header, size_t size);
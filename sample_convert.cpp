@@ -0,0 +1,273 @@
+#include "sample_convert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SAMPLE_CONVERT_X86 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 每次转换的样本数，中间结果保存在栈上的浮点缓冲区中，始终位于L1缓存
+const size_t kChunkSamples = 1024;
+
+// 各整数格式的满幅值
+float FullScale(SampleType type) {
+    switch (type) {
+        case SampleType::UInt8: return 128.0f;
+        case SampleType::Int16: return 32768.0f;
+        case SampleType::Int24: return 8388608.0f;
+        case SampleType::Int32: return 2147483648.0f;
+        default: return 1.0f;
+    }
+}
+
+int32_t LoadInt24(const uint8_t* p) {
+    // 先放到高24位再算术右移，完成符号扩展
+    return static_cast<int32_t>(static_cast<uint32_t>(p[0]) << 8 |
+                                static_cast<uint32_t>(p[1]) << 16 |
+                                static_cast<uint32_t>(p[2]) << 24) >> 8;
+}
+
+// 连续的源样本转换为满幅为[-1, 1)的浮点数
+void ToFloat(const uint8_t* src, SampleType type, size_t count, float* out) {
+    size_t i = 0;
+    switch (type) {
+        case SampleType::UInt8:
+            for (; i < count; ++i) {
+                out[i] = (static_cast<int>(src[i]) - 128) * (1.0f / 128.0f);
+            }
+            break;
+        case SampleType::Int16: {
+#ifdef SAMPLE_CONVERT_X86
+            const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+            for (; i + 8 <= count; i += 8) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                // 放到32位的高16位后算术右移，完成符号扩展
+                __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+                __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+                _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+            }
+#endif
+            for (; i < count; ++i) {
+                int16_t value;
+                std::memcpy(&value, src + i * 2, 2);
+                out[i] = value * (1.0f / 32768.0f);
+            }
+            break;
+        }
+        case SampleType::Int24:
+            for (; i < count; ++i) {
+                out[i] = LoadInt24(src + i * 3) * (1.0f / 8388608.0f);
+            }
+            break;
+        case SampleType::Int32: {
+#ifdef SAMPLE_CONVERT_X86
+            const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+            for (; i + 4 <= count; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+                _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+            }
+#endif
+            for (; i < count; ++i) {
+                int32_t value;
+                std::memcpy(&value, src + i * 4, 4);
+                out[i] = static_cast<float>(value) * (1.0f / 2147483648.0f);
+            }
+            break;
+        }
+        case SampleType::Float32:
+            std::memcpy(out, src, count * sizeof(float));
+            break;
+    }
+}
+
+// 由帧号和通道号得到32位伪随机数（计数器式哈希），不需要在块之间保存状态
+inline uint32_t DitherHash(uint64_t frame, uint32_t channel) {
+    uint64_t x = frame * 0x9E3779B97F4A7C15ull + (static_cast<uint64_t>(channel) << 32 | 0x5bd1e995u);
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 29;
+    return static_cast<uint32_t>(x);
+}
+
+// 加入TPDF抖动：两个[0, 1)均匀分布之差，幅度为目标格式的±1 LSB
+void AddDither(float* samples, size_t count, float lsb, uint64_t first_frame, int channel) {
+    const float unit = lsb / 65536.0f;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t r = DitherHash(first_frame + i, static_cast<uint32_t>(channel));
+        samples[i] += (static_cast<float>(r & 0xFFFF) - static_cast<float>(r >> 16)) * unit;
+    }
+}
+
+// 放大到整数满幅后限制范围，NaN转换为0
+// SIMD路径与标量路径对NaN的处理必须相同，否则结果会随样本在块中的位置和输出间隔变化
+inline float ScaleToRange(float value, float scale, float low, float high) {
+    float scaled = value * scale;
+    return scaled == scaled ? std::min(std::max(scaled, low), high) : 0.0f;
+}
+
+#ifdef SAMPLE_CONVERT_X86
+inline __m128 ScaleToRange(__m128 value, __m128 scale, __m128 low, __m128 high) {
+    __m128 scaled = _mm_mul_ps(value, scale);
+    scaled = _mm_and_ps(scaled, _mm_cmpord_ps(scaled, scaled));
+    return _mm_min_ps(_mm_max_ps(scaled, low), high);
+}
+#endif
+
+// 浮点样本转换为目标格式，按stride字节间隔写出
+void FromFloat(const float* in, size_t count, uint8_t* dst, size_t stride, SampleType type) {
+    size_t i = 0;
+    if (type == SampleType::Float32) {
+        if (stride == sizeof(float)) {
+            std::memcpy(dst, in, count * sizeof(float));
+            return;
+        }
+        for (; i < count; ++i) {
+            std::memcpy(dst + i * stride, in + i, sizeof(float));
+        }
+        return;
+    }
+
+    // 放大到整数满幅后限制范围，int32的上限取float能表示的小于2^31的最大值
+    const float scale = FullScale(type);
+    const float low = -scale;
+    const float high = type == SampleType::Int32 ? 2147483520.0f : scale - 1.0f;
+    switch (type) {
+        case SampleType::UInt8:
+            for (; i < count; ++i) {
+                long value = std::lrint(ScaleToRange(in[i], scale, low, high));
+                dst[i * stride] = static_cast<uint8_t>(value + 128);
+            }
+            break;
+        case SampleType::Int16: {
+#ifdef SAMPLE_CONVERT_X86
+            if (stride == 2) {
+                const __m128 vscale = _mm_set1_ps(scale);
+                const __m128 vlow = _mm_set1_ps(low);
+                const __m128 vhigh = _mm_set1_ps(high);
+                for (; i + 8 <= count; i += 8) {
+                    __m128 a = ScaleToRange(_mm_loadu_ps(in + i), vscale, vlow, vhigh);
+                    __m128 b = ScaleToRange(_mm_loadu_ps(in + i + 4), vscale, vlow, vhigh);
+                    // cvtps按当前舍入模式（默认最近偶数）取整，与lrint一致
+                    __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), packed);
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                int16_t value = static_cast<int16_t>(std::lrint(ScaleToRange(in[i], scale, low, high)));
+                std::memcpy(dst + i * stride, &value, 2);
+            }
+            break;
+        }
+        case SampleType::Int24: {
+#ifdef SAMPLE_CONVERT_X86
+            // 向量化完成缩放、限幅和取整，再逐个写出3字节
+            const __m128 vscale = _mm_set1_ps(scale);
+            const __m128 vlow = _mm_set1_ps(low);
+            const __m128 vhigh = _mm_set1_ps(high);
+            alignas(16) int32_t values[4];
+            for (; i + 4 <= count; i += 4) {
+                __m128 a = ScaleToRange(_mm_loadu_ps(in + i), vscale, vlow, vhigh);
+                _mm_store_si128(reinterpret_cast<__m128i*>(values), _mm_cvtps_epi32(a));
+                for (int k = 0; k < 4; ++k) {
+                    uint8_t* p = dst + (i + k) * stride;
+                    p[0] = static_cast<uint8_t>(values[k]);
+                    p[1] = static_cast<uint8_t>(values[k] >> 8);
+                    p[2] = static_cast<uint8_t>(values[k] >> 16);
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                int32_t value = static_cast<int32_t>(std::lrint(ScaleToRange(in[i], scale, low, high)));
+                uint8_t* p = dst + i * stride;
+                p[0] = static_cast<uint8_t>(value);
+                p[1] = static_cast<uint8_t>(value >> 8);
+                p[2] = static_cast<uint8_t>(value >> 16);
+            }
+            break;
+        }
+        case SampleType::Int32: {
+#ifdef SAMPLE_CONVERT_X86
+            if (stride == 4) {
+                const __m128 vscale = _mm_set1_ps(scale);
+                const __m128 vlow = _mm_set1_ps(low);
+                const __m128 vhigh = _mm_set1_ps(high);
+                for (; i + 4 <= count; i += 4) {
+                    __m128 a = ScaleToRange(_mm_loadu_ps(in + i), vscale, vlow, vhigh);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_cvtps_epi32(a));
+                }
+            }
+#endif
+            for (; i < count; ++i) {
+                int32_t value = static_cast<int32_t>(std::lrint(ScaleToRange(in[i], scale, low, high)));
+                std::memcpy(dst + i * stride, &value, 4);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+} // namespace
+
+int SampleTypeBytes(SampleType type) {
+    switch (type) {
+        case SampleType::UInt8: return 1;
+        case SampleType::Int16: return 2;
+        case SampleType::Int24: return 3;
+        case SampleType::Int32: return 4;
+        case SampleType::Float32: return 4;
+    }
+    return 0;
+}
+
+bool SampleTypeNeedsDither(SampleType source, SampleType target) {
+    if (target == SampleType::Float32) {
+        return false;
+    }
+    if (source == SampleType::Float32) {
+        return true;
+    }
+    return SampleTypeBytes(target) < SampleTypeBytes(source);
+}
+
+void SamplesToFloat(const uint8_t* src, SampleType source, size_t count, float* out) {
+    ToFloat(src, source, count, out);
+}
+
+void FloatToSamples(const float* in, size_t count, uint8_t* dst, size_t dst_stride, SampleType target,
+                    bool dither, uint64_t first_frame, int channel) {
+    if (dither && target != SampleType::Float32) {
+        // 抖动加在副本上，调用方的数据保持不变
+        float buffer[kChunkSamples];
+        float lsb = 1.0f / FullScale(target);
+        for (size_t done = 0; done < count; done += kChunkSamples) {
+            size_t n = std::min(kChunkSamples, count - done);
+            std::memcpy(buffer, in + done, n * sizeof(float));
+            AddDither(buffer, n, lsb, first_frame + done, channel);
+            FromFloat(buffer, n, dst + done * dst_stride, dst_stride, target);
+        }
+        return;
+    }
+    FromFloat(in, count, dst, dst_stride, target);
+}
+
+void ConvertSamples(const uint8_t* src, SampleType source, size_t count,
+                    uint8_t* dst, size_t dst_stride, SampleType target,
+                    bool dither, uint64_t first_frame, int channel) {
+    bool add_dither = dither && SampleTypeNeedsDither(source, target);
+    size_t src_bytes = static_cast<size_t>(SampleTypeBytes(source));
+
+    float buffer[kChunkSamples];
+    for (size_t done = 0; done < count; done += kChunkSamples) {
+        size_t n = std::min(kChunkSamples, count - done);
+        ToFloat(src + done * src_bytes, source, n, buffer);
+        FloatToSamples(buffer, n, dst + done * dst_stride, dst_stride, target, add_dither, first_frame + done, channel);
+    }
+}
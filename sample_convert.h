@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 样本格式
+enum class SampleType {
+    UInt8,      // 8位无符号整数（WAV的8位格式）
+    Int16,
+    Int24,
+    Int32,
+    Float32     // IEEE 754单精度浮点，满幅为[-1, 1)
+};
+
+// 每个样本的字节数
+int SampleTypeBytes(SampleType type);
+
+// 是否需要在转换时加入抖动：目标为整数且精度低于源格式（或源为浮点）时需要
+bool SampleTypeNeedsDither(SampleType source, SampleType target);
+
+// 把count个连续样本转换为满幅为[-1, 1)的浮点数
+void SamplesToFloat(const uint8_t* src, SampleType source, size_t count, float* out);
+
+// 把count个浮点样本转换为target格式，按dst_stride字节间隔写入dst，整数输出四舍五入并限制在满幅范围内
+// dither为true且目标为整数时加入TPDF抖动，抖动的确定方式与ConvertSamples相同
+void FloatToSamples(const float* in, size_t count, uint8_t* dst, size_t dst_stride, SampleType target,
+                    bool dither, uint64_t first_frame, int channel);
+
+// 把一个通道中count个连续样本从source格式转换为target格式，结果按dst_stride字节间隔写入dst，
+// dst_stride等于目标样本大小时连续写入，否则可直接写入多通道输出文件的交织缓冲区
+// 转换经由单精度浮点，整数输出四舍五入并限制在满幅范围内
+// dither为true时在量化前加入幅度为±1 LSB的TPDF抖动，抖动由(first_frame + i, channel)确定，
+// 与分块方式和线程数无关，相同输入总是得到相同输出
+void ConvertSamples(const uint8_t* src, SampleType source, size_t count,
+                    uint8_t* dst, size_t dst_stride, SampleType target,
+                    bool dither, uint64_t first_frame, int channel);
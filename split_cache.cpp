@@ -0,0 +1,305 @@
+#include "split_cache.h"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 记录文件第一行，格式变化时修改版本号，旧记录整体作废
+const char kManifestHeader[] = "wav_split_cache 1";
+
+// 哈希时读取的文件开头和末尾的字节数
+const size_t kHashBytes = 64 * 1024;
+
+// 字段以制表符分隔，字段中的反斜杠、制表符和换行转义
+std::string Escape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c; break;
+        }
+    }
+    return escaped;
+}
+
+std::string Unescape(const std::string& text) {
+    std::string plain;
+    plain.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            plain += text[i];
+            continue;
+        }
+        switch (text[++i]) {
+            case 't': plain += '\t'; break;
+            case 'n': plain += '\n'; break;
+            case 'r': plain += '\r'; break;
+            default: plain += text[i]; break;
+        }
+    }
+    return plain;
+}
+
+std::vector<std::string> SplitFields(const std::string& line) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    for (;;) {
+        size_t end = line.find('\t', start);
+        fields.push_back(Unescape(line.substr(start, end == std::string::npos ? std::string::npos : end - start)));
+        if (end == std::string::npos) {
+            return fields;
+        }
+        start = end + 1;
+    }
+}
+
+std::string ToUtf8(const std::wstring& text) {
+    return fs::path(text).u8string();
+}
+
+std::wstring FromUtf8(const std::string& text) {
+    return fs::u8path(text).wstring();
+}
+
+bool ParseUnsigned(const std::string& text, uint64_t& value) {
+    if (text.empty()) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return true;
+}
+
+bool ParseSigned(const std::string& text, int64_t& value) {
+    uint64_t magnitude = 0;
+    bool negative = !text.empty() && text[0] == '-';
+    if (!ParseUnsigned(negative ? text.substr(1) : text, magnitude)) {
+        return false;
+    }
+    value = negative ? -static_cast<int64_t>(magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+}
+
+// FNV-1a，只用于发现内容变化，不需要抗碰撞
+uint64_t Fnv1a(const char* data, size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// 文件开头和末尾各kHashBytes字节的哈希，文件较小时两段重叠也不影响结果的确定性
+bool SampledHash(const std::wstring& path, uint64_t size, uint64_t& hash) {
+    std::ifstream file(fs::path(path), std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::vector<char> buffer(kHashBytes);
+    hash = 0xCBF29CE484222325ull;
+    file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    hash = Fnv1a(buffer.data(), static_cast<size_t>(file.gcount()), hash);
+    if (size > kHashBytes) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(size - kHashBytes));
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = Fnv1a(buffer.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+    // 0表示未计算哈希
+    if (hash == 0) {
+        hash = 1;
+    }
+    return true;
+}
+
+} // namespace
+
+std::wstring SplitCache::Key(const std::wstring& path) {
+    std::error_code ec;
+    fs::path absolute = fs::absolute(fs::path(path), ec);
+    return (ec ? fs::path(path) : absolute).lexically_normal().wstring();
+}
+
+bool SplitCache::Load(const std::wstring& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    entries_.clear();
+    outputs_.clear();
+
+    std::ifstream file(fs::path(path), std::ios::binary);
+    if (!file) {
+        std::error_code ec;
+        return !fs::exists(fs::path(path), ec);
+    }
+    std::string line;
+    if (!std::getline(file, line) || line != kManifestHeader) {
+        return true;
+    }
+    while (std::getline(file, line)) {
+        // 路径、大小、修改时间、哈希、参数、输出数，之后每个输出为路径和大小
+        std::vector<std::string> fields = SplitFields(line);
+        Entry entry;
+        uint64_t output_count = 0;
+        if (fields.size() < 6 ||
+            !ParseUnsigned(fields[1], entry.state.size) ||
+            !ParseSigned(fields[2], entry.state.mtime) ||
+            !ParseUnsigned(fields[3], entry.state.hash) ||
+            !ParseUnsigned(fields[5], output_count) ||
+            fields.size() != 6 + output_count * 2) {
+            continue;
+        }
+        entry.settings = fields[4];
+        bool valid = true;
+        for (size_t i = 0; i < output_count && valid; ++i) {
+            Output output;
+            output.path = FromUtf8(fields[6 + i * 2]);
+            valid = ParseUnsigned(fields[7 + i * 2], output.size);
+            entry.outputs.push_back(std::move(output));
+        }
+        if (!valid) {
+            continue;
+        }
+        for (const auto& output : entry.outputs) {
+            outputs_.insert(output.path);
+        }
+        entries_[FromUtf8(fields[0])] = std::move(entry);
+    }
+    return true;
+}
+
+bool SplitCache::Save() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) {
+        return false;
+    }
+    fs::path target(path_);
+    fs::path temporary = target;
+    temporary += L".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << kManifestHeader << '\n';
+        for (const auto& item : entries_) {
+            const Entry& entry = item.second;
+            file << Escape(ToUtf8(item.first)) << '\t' << entry.state.size << '\t' << entry.state.mtime << '\t'
+                 << entry.state.hash << '\t' << Escape(entry.settings) << '\t' << entry.outputs.size();
+            for (const auto& output : entry.outputs) {
+                file << '\t' << Escape(ToUtf8(output.path)) << '\t' << output.size;
+            }
+            file << '\n';
+        }
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temporary, target, ec);
+    return !ec;
+}
+
+bool SplitCache::Stat(const std::wstring& input, InputState& state) const {
+    fs::path path(input);
+    std::error_code ec;
+    state = InputState();
+    state.size = fs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    state.mtime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+    if (ec) {
+        return false;
+    }
+    return !use_hash_ || SampledHash(input, state.size, state.hash);
+}
+
+bool SplitCache::IsUpToDate(const std::wstring& input, const InputState& state, const std::string& settings) const {
+    std::vector<Output> outputs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(Key(input));
+        if (it == entries_.end()) {
+            return false;
+        }
+        const Entry& entry = it->second;
+        // 未启用哈希时不比较哈希，启用后旧记录中没有哈希的文件需要重新拆分
+        if (entry.state.size != state.size || entry.state.mtime != state.mtime ||
+            (use_hash_ && entry.state.hash != state.hash) || entry.settings != settings) {
+            return false;
+        }
+        outputs = entry.outputs;
+    }
+    // 在锁外取输出文件的状态，不阻塞其他线程
+    for (const auto& output : outputs) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(fs::path(output.path), ec);
+        if (ec || size != output.size) {
+            return false;
+        }
+    }
+    // 全部通道静音时可能没有输出文件，记录本身说明该文件已经处理过
+    return true;
+}
+
+void SplitCache::Record(const std::wstring& input, const InputState& state, const std::string& settings,
+                        const std::vector<std::wstring>& outputs) {
+    Entry entry;
+    entry.state = state;
+    entry.settings = settings;
+    for (const auto& path : outputs) {
+        Output output;
+        output.path = Key(path);
+        std::error_code ec;
+        output.size = fs::file_size(fs::path(path), ec);
+        if (ec) {
+            Remove(input);
+            return;
+        }
+        entry.outputs.push_back(std::move(output));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& slot = entries_[Key(input)];
+    for (const auto& output : slot.outputs) {
+        outputs_.erase(output.path);
+    }
+    for (const auto& output : entry.outputs) {
+        outputs_.insert(output.path);
+    }
+    slot = std::move(entry);
+}
+
+void SplitCache::Remove(const std::wstring& input) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(Key(input));
+    if (it == entries_.end()) {
+        return;
+    }
+    for (const auto& output : it->second.outputs) {
+        outputs_.erase(output.path);
+    }
+    entries_.erase(it);
+}
+
+bool SplitCache::IsOutput(const std::wstring& path) const {
+    std::wstring key = Key(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return outputs_.count(key) > 0;
+}
+
+size_t SplitCache::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
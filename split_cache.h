@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 重复运行批处理时的拆分记录：保存每个输入文件的大小、修改时间、可选的内容哈希、
+// 拆分参数以及输出文件的路径和大小。输入和输出都没有变化时可以跳过该文件，
+// 判断只需要对输入和输出文件各取一次文件状态
+// 查询和记录可以在多个工作线程中同时进行
+class SplitCache {
+public:
+    // 输入文件的状态，拆分之前取得，拆分完成后连同输出一起记录
+    struct InputState {
+        uint64_t size = 0;
+        int64_t mtime = 0;      // 修改时间，文件时钟的计数值
+        uint64_t hash = 0;      // 未启用哈希时为0
+    };
+
+    // 启用后同时比较文件开头和末尾各64KB的哈希，修改后保留了修改时间的文件也能识别
+    void SetUseHash(bool enabled) { use_hash_ = enabled; }
+
+    // 读取记录文件，文件不存在时为空记录；无法识别的行被忽略
+    // 保存时写到同一路径，不存在时返回true
+    bool Load(const std::wstring& path);
+
+    // 先写入临时文件再替换，中途退出不会留下不完整的记录
+    bool Save() const;
+
+    // 取得输入文件的当前状态，文件不存在时返回false
+    bool Stat(const std::wstring& input, InputState& state) const;
+
+    // 输入文件状态、拆分参数与记录相同，且记录的输出文件都存在、大小未变时返回true
+    bool IsUpToDate(const std::wstring& input, const InputState& state, const std::string& settings) const;
+
+    // 记录成功拆分的文件及其输出，替换已有的记录
+    void Record(const std::wstring& input, const InputState& state, const std::string& settings,
+                const std::vector<std::wstring>& outputs);
+
+    // 删除文件的记录，拆分失败时调用，避免下次按旧记录跳过
+    void Remove(const std::wstring& input);
+
+    // path是否为某个已记录文件的输出，目录扫描时用于排除上次运行生成的文件
+    bool IsOutput(const std::wstring& path) const;
+
+    size_t Size() const;
+
+private:
+    struct Output {
+        std::wstring path;
+        uint64_t size = 0;
+    };
+    struct Entry {
+        InputState state;
+        std::string settings;
+        std::vector<Output> outputs;
+    };
+
+    // 记录中的路径统一为绝对路径，从不同的工作目录运行时仍能匹配
+    static std::wstring Key(const std::wstring& path);
+
+    std::wstring path_;
+    bool use_hash_ = false;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::wstring, Entry> entries_;
+    std::unordered_set<std::wstring> outputs_;  // 所有记录中的输出文件
+};
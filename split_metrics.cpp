@@ -0,0 +1,87 @@
+#include "split_metrics.h"
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+void SplitMetrics::Add(const SplitMetrics& other) {
+    bytes_read += other.bytes_read;
+    bytes_written += other.bytes_written;
+    load_seconds += other.load_seconds;
+    load_cpu_seconds += other.load_cpu_seconds;
+    read_seconds += other.read_seconds;
+    read_cpu_seconds += other.read_cpu_seconds;
+    deinterleave_seconds += other.deinterleave_seconds;
+    deinterleave_cpu_seconds += other.deinterleave_cpu_seconds;
+    write_seconds += other.write_seconds;
+    write_cpu_seconds += other.write_cpu_seconds;
+    write_wait_seconds += other.write_wait_seconds;
+    split_seconds += other.split_seconds;
+    allocation_count += other.allocation_count;
+    allocated_bytes += other.allocated_bytes;
+    peak_buffer_bytes = std::max(peak_buffer_bytes, other.peak_buffer_bytes);
+}
+
+void SplitMetricsSummary::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_ = SplitMetrics();
+    files_ = 0;
+}
+
+void SplitMetricsSummary::Add(const SplitMetrics& metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_.Add(metrics);
+    ++files_;
+}
+
+SplitMetrics SplitMetricsSummary::Total() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_;
+}
+
+int SplitMetricsSummary::Files() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_;
+}
+
+double WallClockSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double ThreadCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+        return 0.0;
+    }
+    // FILETIME以100纳秒为单位
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernel_time.dwLowDateTime;
+    kernel.HighPart = kernel_time.dwHighDateTime;
+    user.LowPart = user_time.dwLowDateTime;
+    user.HighPart = user_time.dwHighDateTime;
+    return static_cast<double>(kernel.QuadPart + user.QuadPart) * 1e-7;
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0.0;
+    }
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1e-9;
+#endif
+}
+
+StageTimer::StageTimer(double& wall_seconds, double& cpu_seconds)
+    : wall_seconds_(wall_seconds), cpu_seconds_(cpu_seconds),
+      wall_start_(WallClockSeconds()), cpu_start_(ThreadCpuSeconds()) {
+}
+
+StageTimer::~StageTimer() {
+    wall_seconds_ += WallClockSeconds() - wall_start_;
+    cpu_seconds_ += ThreadCpuSeconds() - cpu_start_;
+}
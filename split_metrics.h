@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+
+// 单个文件的处理统计，时间单位为秒
+// 多线程执行的阶段（分段拆分、后台写入）累加各线程的时间，可能大于墙钟时间
+struct SplitMetrics {
+    uint64_t bytes_read = 0;            // 从源文件读取的字节数
+    uint64_t bytes_written = 0;         // 写入全部输出文件的字节数（含文件头）
+    double load_seconds = 0.0;          // 加载：解析文件头，内存模式下还包括读入data块
+    double load_cpu_seconds = 0.0;
+    double read_seconds = 0.0;          // 拆分时按块读取源数据
+    double read_cpu_seconds = 0.0;
+    double deinterleave_seconds = 0.0;  // 通道分离内核
+    double deinterleave_cpu_seconds = 0.0;
+    double write_seconds = 0.0;         // 后台线程写入输出文件
+    double write_cpu_seconds = 0.0;
+    double write_wait_seconds = 0.0;    // 分离线程等待写入完成的时间，较大时说明输出I/O是瓶颈
+    double split_seconds = 0.0;         // SplitChannels的墙钟时间
+    uint64_t allocation_count = 0;      // 处理过程中缓冲区的分配次数，缓冲区复用后稳定状态下为0
+    uint64_t allocated_bytes = 0;       // 处理过程中分配的缓冲区字节数
+    uint64_t peak_buffer_bytes = 0;     // 同时占用的缓冲区峰值
+
+    // 累加另一个文件的统计，峰值取最大值
+    void Add(const SplitMetrics& other);
+};
+
+// 批量处理的汇总统计，可由多个工作线程同时添加
+class SplitMetricsSummary {
+public:
+    void Reset();
+    void Add(const SplitMetrics& metrics);
+
+    SplitMetrics Total() const;
+    int Files() const;
+
+private:
+    mutable std::mutex mutex_;
+    SplitMetrics total_;
+    int files_ = 0;
+};
+
+// 单调时钟的当前时间
+double WallClockSeconds();
+
+// 当前线程已使用的CPU时间
+double ThreadCpuSeconds();
+
+// 在作用域内计时，析构时把墙钟时间和当前线程的CPU时间累加到指定变量
+class StageTimer {
+public:
+    StageTimer(double& wall_seconds, double& cpu_seconds);
+    ~StageTimer();
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    double& wall_seconds_;
+    double& cpu_seconds_;
+    double wall_start_;
+    double cpu_start_;
+};
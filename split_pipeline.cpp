@@ -0,0 +1,240 @@
+#include "split_pipeline.h"
+#include "file_io.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+
+// Split()调用期间一个文件的共享状态，位于调用线程的栈上
+struct SplitPipeline::FileState {
+    const Job* job = nullptr;
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint64_t done = 0;              // 已写完的块数
+    uint64_t processed = 0;         // 已写完的帧数
+    std::atomic<bool> failed{false};
+    SplitMetrics metrics;
+};
+
+// 在各阶段之间传递的数据块，缓冲区随块在文件之间复用
+struct SplitPipeline::Block {
+    FileState* file = nullptr;
+    uint64_t first_frame = 0;
+    uint64_t frames = 0;
+    const uint8_t* src = nullptr;   // 读取阶段取得的交错数据
+    std::unique_ptr<uint8_t[]> read_buffer;
+    size_t read_capacity = 0;
+    std::unique_ptr<uint8_t[]> channel_buffer;
+    size_t channel_capacity = 0;
+    std::vector<uint8_t*> channel_ptrs;
+    std::vector<uint8_t> skip;      // 分离阶段标记的不必写入的输出
+    SplitMetrics metrics;           // 本块在各阶段的统计，写入阶段结束时并入文件
+};
+
+SplitPipeline::SplitPipeline(const Options& options)
+    : options_(options),
+      free_blocks_((std::max)(size_t(1), options.max_blocks)),
+      read_queue_((std::max)(size_t(1), options.max_blocks)),
+      deinterleave_queue_((std::max)(size_t(1), options.max_blocks)),
+      write_queue_((std::max)(size_t(1), options.max_blocks)) {
+    options_.max_blocks = (std::max)(size_t(1), options_.max_blocks);
+    options_.block_bytes = (std::max)(size_t(1), options_.block_bytes);
+    // 缓冲区在首次使用时按文件的格式分配，块数固定，总内存受max_blocks限制
+    for (size_t i = 0; i < options_.max_blocks; ++i) {
+        blocks_.push_back(std::make_unique<Block>());
+        free_blocks_.Push(blocks_.back().get());
+    }
+    for (int i = 0; i < (std::max)(1, options_.reader_threads); ++i) {
+        readers_.emplace_back(&SplitPipeline::ReadStage, this);
+    }
+    for (int i = 0; i < (std::max)(1, options_.deinterleave_threads); ++i) {
+        deinterleavers_.emplace_back(&SplitPipeline::DeinterleaveStage, this);
+    }
+    for (int i = 0; i < (std::max)(1, options_.writer_threads); ++i) {
+        writers_.emplace_back(&SplitPipeline::WriteStage, this);
+    }
+}
+
+SplitPipeline::~SplitPipeline() {
+    // 先关闭空闲块队列，等待空闲块的Split()醒来后不再提交新块，只等已提交的块写完
+    // （写入阶段仍把在途的块归还到队列中，Push不受Close影响）
+    free_blocks_.Close();
+    // 按阶段顺序关闭，上游的块全部交给下游后下游才会退出
+    read_queue_.Close();
+    for (auto& thread : readers_) {
+        thread.join();
+    }
+    deinterleave_queue_.Close();
+    for (auto& thread : deinterleavers_) {
+        thread.join();
+    }
+    write_queue_.Close();
+    for (auto& thread : writers_) {
+        thread.join();
+    }
+}
+
+bool SplitPipeline::Split(const Job& job, SplitMetrics& metrics) {
+    if (job.frame_bytes == 0 || !job.split || job.outputs.empty()) {
+        return false;
+    }
+
+    FileState state;
+    state.job = &job;
+    uint64_t frames_per_block = (std::max<uint64_t>)(1, options_.block_bytes / job.frame_bytes);
+    uint64_t submitted = 0;
+    uint64_t reported = 0;
+    double wait_seconds = 0.0;
+
+    // 取得空闲块后更新进度，进度回调始终在调用线程上执行
+    auto report = [&](bool wait_all) {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        if (wait_all) {
+            state.cv.wait(lock, [&] { return state.done == submitted || state.processed != reported; });
+        }
+        uint64_t processed = state.processed;
+        lock.unlock();
+        if (processed != reported) {
+            reported = processed;
+            if (job.progress) {
+                job.progress(processed, job.frames);
+            }
+        }
+    };
+
+    for (uint64_t first_frame = 0; first_frame < job.frames && !state.failed; first_frame += frames_per_block) {
+        Block* block = nullptr;
+        bool popped;
+        {
+            // 块全部在途时在这里等待，等待时间说明下游阶段跟不上
+            double wait_cpu_seconds = 0.0;
+            StageTimer timer(wait_seconds, wait_cpu_seconds);
+            popped = free_blocks_.Pop(block);
+        }
+        // 空闲块队列已关闭（流水线正在析构），剩余的块不再提交，本文件按失败处理
+        if (!popped) {
+            state.failed = true;
+            break;
+        }
+        block->file = &state;
+        block->first_frame = first_frame;
+        block->frames = (std::min)(frames_per_block, job.frames - first_frame);
+        block->src = nullptr;
+        block->metrics = SplitMetrics();
+        ++submitted;
+        read_queue_.Push(block);
+        report(false);
+    }
+
+    // 等待已提交的块全部写完，state在此之后不再被任何阶段访问
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (state.done == submitted) {
+                break;
+            }
+        }
+        report(true);
+    }
+    report(false);
+
+    state.metrics.write_wait_seconds += wait_seconds;
+    state.metrics.peak_buffer_bytes = BufferBytes();
+    metrics.Add(state.metrics);
+    return !state.failed;
+}
+
+void SplitPipeline::Reserve(std::unique_ptr<uint8_t[]>& buffer, size_t& capacity, size_t size) {
+    if (capacity >= size) {
+        return;
+    }
+    buffer.reset(new uint8_t[size]);
+    buffer_bytes_ += size - capacity;
+    capacity = size;
+}
+
+void SplitPipeline::ReadStage() {
+    Block* block;
+    while (read_queue_.Pop(block)) {
+        const Job& job = *block->file->job;
+        if (!block->file->failed) {
+            size_t bytes = static_cast<size_t>(block->frames * job.frame_bytes);
+            if (job.needs_read_buffer && block->read_capacity < bytes) {
+                ++block->metrics.allocation_count;
+                block->metrics.allocated_bytes += bytes;
+                Reserve(block->read_buffer, block->read_capacity, bytes);
+            }
+            StageTimer timer(block->metrics.read_seconds, block->metrics.read_cpu_seconds);
+            block->src = job.read(block->first_frame * job.frame_bytes, bytes, block->read_buffer.get());
+            if (!block->src) {
+                block->file->failed = true;
+            } else if (job.needs_read_buffer) {
+                block->metrics.bytes_read += bytes;
+            }
+        }
+        deinterleave_queue_.Push(block);
+    }
+}
+
+void SplitPipeline::DeinterleaveStage() {
+    Block* block;
+    while (deinterleave_queue_.Pop(block)) {
+        const Job& job = *block->file->job;
+        if (!block->file->failed) {
+            size_t total_bytes = 0;
+            for (const auto& output : job.outputs) {
+                total_bytes += static_cast<size_t>(block->frames * output.frame_bytes);
+            }
+            if (block->channel_capacity < total_bytes) {
+                ++block->metrics.allocation_count;
+                block->metrics.allocated_bytes += total_bytes;
+                Reserve(block->channel_buffer, block->channel_capacity, total_bytes);
+            }
+            block->channel_ptrs.resize(job.outputs.size());
+            uint8_t* base = block->channel_buffer.get();
+            for (size_t out = 0; out < job.outputs.size(); ++out) {
+                block->channel_ptrs[out] = base;
+                base += block->frames * job.outputs[out].frame_bytes;
+            }
+            block->skip.assign(job.outputs.size(), 0);
+            StageTimer timer(block->metrics.deinterleave_seconds, block->metrics.deinterleave_cpu_seconds);
+            job.split(block->src, block->first_frame, static_cast<size_t>(block->frames), block->channel_ptrs.data(),
+                      block->skip.data());
+        }
+        write_queue_.Push(block);
+    }
+}
+
+void SplitPipeline::WriteStage() {
+    Block* block;
+    while (write_queue_.Pop(block)) {
+        FileState& file = *block->file;
+        const Job& job = *file.job;
+        if (!file.failed) {
+            StageTimer timer(block->metrics.write_seconds, block->metrics.write_cpu_seconds);
+            for (size_t out = 0; out < job.outputs.size(); ++out) {
+                if (block->skip[out]) {
+                    continue;
+                }
+                const Output& output = job.outputs[out];
+                size_t bytes = static_cast<size_t>(block->frames * output.frame_bytes);
+                if (!output.file->WriteAt(output.header_size + block->first_frame * output.frame_bytes,
+                                          block->channel_ptrs[out], bytes)) {
+                    file.failed = true;
+                    break;
+                }
+                block->metrics.bytes_written += bytes;
+            }
+        }
+
+        // 先归还块再通知，Split()返回后file不再有效
+        SplitMetrics metrics = block->metrics;
+        uint64_t frames = block->frames;
+        free_blocks_.Push(block);
+
+        std::lock_guard<std::mutex> lock(file.mutex);
+        file.metrics.Add(metrics);
+        file.processed += frames;
+        ++file.done;
+        file.cv.notify_all();
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "bounded_queue.h"
+#include "split_metrics.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class RandomAccessFile;
+
+// 跨文件的三级流水线：读取、通道分离、写入三个阶段各有自己的线程，
+// 阶段之间用有界无锁队列传递按帧对齐的数据块，多个文件的块在流水线中交错处理，
+// 读盘、计算和写盘可以同时进行
+// 数据块来自固定数量的块池，块全部在途时提交方等待（背压），在途数据占用的内存不超过块数乘以块大小
+class SplitPipeline {
+public:
+    struct Options {
+        int reader_threads = 2;             // 读取阶段线程数，机械硬盘上宜少，避免来回寻道
+        int deinterleave_threads = 2;       // 通道分离阶段线程数
+        int writer_threads = 4;             // 写入阶段线程数
+        size_t block_bytes = 4 * 1024 * 1024;  // 每块读取的字节数，按文件的block_align向下对齐
+        size_t max_blocks = 16;             // 同时在途的块数上限
+    };
+
+    // 一个输出文件：数据写在文件头之后，每帧frame_bytes字节
+    struct Output {
+        RandomAccessFile* file = nullptr;
+        uint64_t header_size = 0;
+        size_t frame_bytes = 0;
+    };
+
+    // 一个文件的拆分任务，由AudioProcessor填写
+    struct Job {
+        // 取得data块中[offset, offset + bytes)的数据，可以读入block，也可以直接返回已在内存中的地址
+        std::function<const uint8_t*(uint64_t offset, size_t bytes, uint8_t* block)> read;
+        bool needs_read_buffer = true;      // read是否需要block（内存模式下不需要）
+        // 把从first_frame开始的frames帧交织数据拆分到各输出文件的缓冲区dst[0..outputs.size()-1]
+        // skip[out]初始为0，置为非0表示该输出这一块全为静音，不必写入（输出文件已预先扩展，未写入的部分为零）
+        std::function<void(const uint8_t* src, uint64_t first_frame, size_t frames, uint8_t* const* dst,
+                           uint8_t* skip)> split;
+        size_t frame_bytes = 0;             // 源数据每帧的字节数
+        uint64_t frames = 0;                // 总帧数
+        std::vector<Output> outputs;
+        // 进度回调，在Split()的调用线程上调用
+        std::function<void(uint64_t processed, uint64_t total)> progress;
+    };
+
+    explicit SplitPipeline(const Options& options);
+    // 等待在途的块处理完后停止各阶段线程，正在等待空闲块的Split()不再提交新块并返回false
+    ~SplitPipeline();
+
+    SplitPipeline(const SplitPipeline&) = delete;
+    SplitPipeline& operator=(const SplitPipeline&) = delete;
+
+    // 拆分一个文件，阻塞到全部块写入完成；多个线程可以同时调用
+    // 各阶段的耗时和字节数累加到metrics
+    bool Split(const Job& job, SplitMetrics& metrics);
+
+    const Options& GetOptions() const { return options_; }
+
+    // 块池当前占用的缓冲区字节数
+    uint64_t BufferBytes() const { return buffer_bytes_.load(); }
+
+private:
+    struct FileState;
+    struct Block;
+
+    void ReadStage();
+    void DeinterleaveStage();
+    void WriteStage();
+
+    // 确保缓冲区至少有size字节，容量不足时重新分配
+    void Reserve(std::unique_ptr<uint8_t[]>& buffer, size_t& capacity, size_t size);
+
+    Options options_;
+    std::vector<std::unique_ptr<Block>> blocks_;
+    std::atomic<uint64_t> buffer_bytes_{0};
+
+    BoundedQueue<Block*> free_blocks_;
+    BoundedQueue<Block*> read_queue_;
+    BoundedQueue<Block*> deinterleave_queue_;
+    BoundedQueue<Block*> write_queue_;
+
+    std::vector<std::thread> readers_;
+    std::vector<std::thread> deinterleavers_;
+    std::vector<std::thread> writers_;
+};
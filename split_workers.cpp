@@ -0,0 +1,59 @@
+#include "split_workers.h"
+
+SplitWorkers::SplitWorkers(int thread_count) {
+    for (int i = 0; i < (thread_count > 0 ? thread_count : 1); ++i) {
+        threads_.emplace_back(&SplitWorkers::Run, this, i);
+    }
+}
+
+SplitWorkers::~SplitWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void SplitWorkers::Start(Function function, void* context, int count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        function_ = function;
+        context_ = context;
+        count_ = count < ThreadCount() ? count : ThreadCount();
+        running_ = count_;
+        ++generation_;
+    }
+    start_cv_.notify_all();
+}
+
+void SplitWorkers::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return running_ == 0; });
+}
+
+void SplitWorkers::Run(int index) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        start_cv_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+        // 本次不参与的线程继续等待下一次任务
+        if (index >= count_) {
+            continue;
+        }
+        Function function = function_;
+        void* context = context_;
+        lock.unlock();
+        function(context, index);
+        lock.lock();
+        if (--running_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 分段拆分的常驻线程：线程在多个文件之间复用，每个文件只唤醒需要的线程，
+// 不再为每个文件创建和销毁线程，提交任务也不分配内存
+class SplitWorkers {
+public:
+    explicit SplitWorkers(int thread_count);
+    ~SplitWorkers();
+
+    SplitWorkers(const SplitWorkers&) = delete;
+    SplitWorkers& operator=(const SplitWorkers&) = delete;
+
+    int ThreadCount() const { return static_cast<int>(threads_.size()); }
+
+    // 在前count个线程上分别执行task(0)..task(count - 1)，提交后立即返回
+    // task在Wait()返回前必须保持有效，count不超过ThreadCount()
+    template <typename Task>
+    void Start(Task& task, int count) {
+        Start(&Invoke<Task>, &task, count);
+    }
+
+    // 等待Start()提交的任务全部完成
+    void Wait();
+
+private:
+    using Function = void (*)(void* context, int index);
+
+    template <typename Task>
+    static void Invoke(void* context, int index) {
+        (*static_cast<Task*>(context))(index);
+    }
+
+    void Start(Function function, void* context, int count);
+    void Run(int index);
+
+    std::mutex mutex_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    Function function_ = nullptr;
+    void* context_ = nullptr;
+    int count_ = 0;             // 本次参与的线程数
+    int running_ = 0;           // 尚未完成的线程数
+    uint64_t generation_ = 0;   // 每次Start()加1，线程据此发现新任务
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
@@ -0,0 +1,184 @@
+// allocation_test.cpp : 重复拆分同格式文件时的堆分配次数测试
+//
+// 替换全局operator new统计全部堆分配（不只是BufferArena中的缓冲区）。
+// 同一个AudioProcessor先处理几个文件进入稳定状态，之后拆分同格式的文件不应再分配内存：
+// 缓冲区、路径、输出文件头和分段拆分的线程都在文件之间复用
+
+#include "audio_processor.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::atomic<uint64_t> g_allocations(0);
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+const int kChannels = 8;
+
+const int kWarmupFiles = 2;
+const int kMeasuredFiles = 4;
+
+int g_failures = 0;
+
+fs::path TestDirectory() {
+    fs::path dir = fs::temp_directory_path() / "wav_split_allocation_test";
+    fs::create_directories(dir);
+    return dir;
+}
+
+// 写入frames帧的8通道16位WAV文件，样本为伪随机值
+fs::path WriteInput(const std::string& name, uint32_t frames) {
+    fs::path path = TestDirectory() / name;
+    uint32_t data_size = frames * kChannels * 2;
+    WAVHeader header = {};
+    std::memcpy(header.riff_id, "RIFF", 4);
+    std::memcpy(header.wave_id, "WAVE", 4);
+    std::memcpy(header.fmt_id, "fmt ", 4);
+    std::memcpy(header.data_id, "data", 4);
+    header.fmt_size = 16;
+    header.audio_format = 1;
+    header.num_channels = kChannels;
+    header.sample_rate = 48000;
+    header.bits_per_sample = 16;
+    header.block_align = kChannels * 2;
+    header.byte_rate = header.sample_rate * header.block_align;
+    header.data_size = data_size;
+    header.file_size = data_size + sizeof(WAVHeader) - 8;
+
+    std::vector<char> data(data_size);
+    uint32_t seed = frames;
+    for (auto& byte : data) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<char>(seed >> 24);
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(data.data(), data.size());
+    return path;
+}
+
+struct Scenario {
+    const char* name;
+    AudioProcessor::InputMode mode;
+    size_t buffer_size;
+    uint32_t frames;
+    uint32_t output_rate;   // 0表示不重采样
+    bool stats;             // 拆分的同时统计各通道（结果只通过接口返回，不写文件）
+    int split_threads;
+};
+
+// 用同一个AudioProcessor重复拆分input，返回稳定状态下kMeasuredFiles个文件的分配总次数
+uint64_t AllocationsPerFile(const Scenario& scenario, const fs::path& input) {
+    AudioProcessor processor;
+    AudioProcessor::AudioFormat format;
+    format.sample_rate = 48000;
+    format.bits_per_sample = 16;
+    format.num_channels = kChannels;
+    processor.SetInputMode(scenario.mode);
+    processor.SetStreamBufferSize(scenario.buffer_size);
+    processor.SetOutputFormat(AudioProcessor::OutputFormat::WAV);
+    processor.SetOutputSampleRate(scenario.output_rate);
+    processor.SetStatsMode(scenario.stats ? AudioProcessor::StatsMode::Api : AudioProcessor::StatsMode::Off);
+    processor.SetSplitThreads(scenario.split_threads);
+
+    // 参数字符串在循环外建立，测试本身不计入分配
+    std::wstring file = input.wstring();
+    std::wstring output_dir = TestDirectory().wstring();
+    std::wstring suffix = L"_out";
+    uint64_t start = 0;
+    for (int i = 0; i < kWarmupFiles + kMeasuredFiles; ++i) {
+        if (i == kWarmupFiles) {
+            start = g_allocations.load();
+        }
+        processor.SetAudioFormat(format);
+        if (!processor.LoadWavFile(file) || !processor.SplitChannels(output_dir, suffix)) {
+            std::fprintf(stderr, "FAIL %s: split failed\n", scenario.name);
+            ++g_failures;
+            return 0;
+        }
+    }
+    return g_allocations.load() - start;
+}
+
+} // namespace
+
+int main() {
+    // 缓冲区大小和文件长度不同，块数相差数十倍，稳定状态下都不应分配内存
+    const Scenario scenarios[] = {
+        {"stream/16K", AudioProcessor::InputMode::Stream, 16 * 1024, 48000, 0, false, 1},
+        {"stream/1K", AudioProcessor::InputMode::Stream, 1024, 48000, 0, false, 1},
+        {"stream/1K/long", AudioProcessor::InputMode::Stream, 1024, 192000, 0, false, 1},
+        {"memory/16K", AudioProcessor::InputMode::Memory, 16 * 1024, 48000, 0, false, 1},
+        {"memory/1K/long", AudioProcessor::InputMode::Memory, 1024, 192000, 0, false, 1},
+        {"mapped/16K", AudioProcessor::InputMode::Mapped, 16 * 1024, 48000, 0, false, 1},
+        {"mapped/1K/long", AudioProcessor::InputMode::Mapped, 1024, 192000, 0, false, 1},
+        {"mapped/1K/4x", AudioProcessor::InputMode::Mapped, 1024, 192000, 0, false, 4},
+        {"memory/1K/4x", AudioProcessor::InputMode::Memory, 1024, 192000, 0, false, 4},
+        {"resample/16K", AudioProcessor::InputMode::Stream, 16 * 1024, 48000, 16000, false, 1},
+        {"resample/1K", AudioProcessor::InputMode::Stream, 1024, 48000, 16000, false, 1},
+        {"resample/1K/long", AudioProcessor::InputMode::Stream, 1024, 192000, 16000, false, 1},
+        {"stats/16K", AudioProcessor::InputMode::Stream, 16 * 1024, 48000, 0, true, 1},
+        {"stats/1K", AudioProcessor::InputMode::Stream, 1024, 48000, 0, true, 1},
+        {"stats/1K/long", AudioProcessor::InputMode::Stream, 1024, 192000, 0, true, 1},
+        {"stats/resample/1K", AudioProcessor::InputMode::Stream, 1024, 192000, 16000, true, 1},
+        {"stats/mapped/1K/4x", AudioProcessor::InputMode::Mapped, 1024, 192000, 0, true, 4},
+    };
+
+    fs::path short_input = WriteInput("input_a.wav", 48000);
+    fs::path long_input = WriteInput("input_b.wav", 192000);
+
+    for (const Scenario& scenario : scenarios) {
+        uint64_t count = AllocationsPerFile(scenario, scenario.frames == 48000 ? short_input : long_input);
+        std::printf("%-18s %llu allocations in %d files\n", scenario.name, static_cast<unsigned long long>(count),
+                    kMeasuredFiles);
+        if (count != 0) {
+            std::fprintf(stderr, "FAIL %s: %llu allocations after warm-up\n", scenario.name,
+                         static_cast<unsigned long long>(count));
+            ++g_failures;
+        }
+    }
+
+    std::error_code ec;
+    fs::remove_all(TestDirectory(), ec);
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+// deinterleave_test.cpp : 通道分离内核与标量参考实现的一致性测试
+//
+// 覆盖8/16/24/32位 × 1~8通道，帧数取SIMD寄存器宽度（16/32字节）附近的边界值，
+// 源和目标指针都故意不对齐；每个指令集级别、编译期特化内核和通道抽取都与标量结果逐字节比较
+
+#include "deinterleave.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+const size_t kFrameCounts[] = {0, 1, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 1023, 1025};
+
+// 指针相对16字节边界的偏移，使加载和存储都不对齐
+const size_t kSourceOffset = 3;
+const size_t kDestOffset = 5;
+
+int g_checks = 0;
+int g_failures = 0;
+
+void Fill(std::vector<uint8_t>& data, uint32_t seed) {
+    for (auto& byte : data) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = static_cast<uint8_t>(seed >> 24);
+    }
+}
+
+void Check(bool ok, const std::string& name, int bytes, int channels, size_t frames) {
+    ++g_checks;
+    if (!ok) {
+        ++g_failures;
+        std::fprintf(stderr, "FAIL %s: bytes=%d channels=%d frames=%zu\n", name.c_str(), bytes, channels, frames);
+    }
+}
+
+// 用kernel拆分src，与expected（每个通道一段）比较；目标缓冲区预先填充，超出范围的写入也会被发现
+bool RunKernel(DeinterleaveKernel kernel, const uint8_t* src, size_t frames, int bytes, int channels,
+               const std::vector<std::vector<uint8_t>>& expected) {
+    size_t channel_bytes = frames * bytes;
+    std::vector<std::vector<uint8_t>> storage(channels, std::vector<uint8_t>(channel_bytes + kDestOffset + 16, 0xA5));
+    std::vector<uint8_t*> dst(channels);
+    for (int ch = 0; ch < channels; ++ch) {
+        dst[ch] = storage[ch].data() + kDestOffset;
+    }
+    kernel(src, frames, bytes, channels, dst.data());
+    for (int ch = 0; ch < channels; ++ch) {
+        if (std::memcmp(dst[ch], expected[ch].data(), channel_bytes) != 0) {
+            return false;
+        }
+        for (size_t i = 0; i < 16; ++i) {
+            if (dst[ch][channel_bytes + i] != 0xA5) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 从标量结果按channels顺序交织得到通道抽取的期望值
+bool RunGather(const uint8_t* src, size_t frames, int bytes, int channels, const std::vector<int>& picked,
+               const std::vector<std::vector<uint8_t>>& reference) {
+    int count = static_cast<int>(picked.size());
+    size_t out_bytes = frames * bytes * count;
+    std::vector<uint8_t> storage(out_bytes + kDestOffset + 16, 0xA5);
+    uint8_t* dst = storage.data() + kDestOffset;
+    GatherChannels(src, frames, bytes, channels, picked.data(), count, dst);
+    for (size_t i = 0; i < frames; ++i) {
+        for (int k = 0; k < count; ++k) {
+            if (std::memcmp(dst + (i * count + k) * bytes, reference[picked[k]].data() + i * bytes, bytes) != 0) {
+                return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < 16; ++i) {
+        if (dst[out_bytes + i] != 0xA5) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    bool has_avx2 = DetectSimdLevel() == SimdLevel::AVX2;
+    std::printf("SIMD level: %s\n", has_avx2 ? "AVX2" : (DetectSimdLevel() == SimdLevel::SSE2 ? "SSE2" : "Scalar"));
+
+    for (int bytes = 1; bytes <= 4; ++bytes) {
+        for (int channels = 1; channels <= 8; ++channels) {
+            for (size_t frames : kFrameCounts) {
+                size_t frame_bytes = static_cast<size_t>(bytes) * channels;
+                std::vector<uint8_t> source(frames * frame_bytes + kSourceOffset);
+                Fill(source, static_cast<uint32_t>(bytes * 131 + channels * 17 + frames));
+                const uint8_t* src = source.data() + kSourceOffset;
+
+                // 标量参考结果
+                std::vector<std::vector<uint8_t>> reference(channels, std::vector<uint8_t>(frames * bytes));
+                std::vector<uint8_t*> ref_ptrs(channels);
+                for (int ch = 0; ch < channels; ++ch) {
+                    ref_ptrs[ch] = reference[ch].data();
+                }
+                DeinterleaveScalar(src, frames, bytes, channels, ref_ptrs.data());
+
+                // 标量参考实现本身按定义逐帧核对
+                bool scalar_ok = true;
+                for (size_t i = 0; i < frames && scalar_ok; ++i) {
+                    for (int ch = 0; ch < channels; ++ch) {
+                        if (std::memcmp(reference[ch].data() + i * bytes, src + i * frame_bytes + ch * bytes,
+                                        bytes) != 0) {
+                            scalar_ok = false;
+                            break;
+                        }
+                    }
+                }
+                Check(scalar_ok, "DeinterleaveScalar", bytes, channels, frames);
+
+                Check(RunKernel(SelectDeinterleaveKernel(bytes, channels, SimdLevel::Scalar), src, frames, bytes,
+                                channels, reference), "Scalar", bytes, channels, frames);
+                Check(RunKernel(SelectDeinterleaveKernel(bytes, channels, SimdLevel::SSE2), src, frames, bytes,
+                                channels, reference), "SSE2", bytes, channels, frames);
+                if (has_avx2) {
+                    Check(RunKernel(SelectDeinterleaveKernel(bytes, channels, SimdLevel::AVX2), src, frames, bytes,
+                                    channels, reference), "AVX2", bytes, channels, frames);
+                }
+                Check(RunKernel(SelectDeinterleaveKernel(bytes, channels), src, frames, bytes, channels, reference),
+                      "auto", bytes, channels, frames);
+                if (DeinterleaveKernel specialized = GetSpecializedDeinterleaveKernel(bytes, channels)) {
+                    Check(RunKernel(specialized, src, frames, bytes, channels, reference), "specialized", bytes,
+                          channels, frames);
+                }
+
+                // 通道抽取：单个通道、逆序全部通道、隔一个取一个
+                for (int ch = 0; ch < channels; ++ch) {
+                    Check(RunGather(src, frames, bytes, channels, {ch}, reference), "GatherChannels(single)", bytes,
+                          channels, frames);
+                }
+                std::vector<int> reversed;
+                std::vector<int> strided;
+                for (int ch = channels - 1; ch >= 0; --ch) {
+                    reversed.push_back(ch);
+                }
+                for (int ch = 0; ch < channels; ch += 2) {
+                    strided.push_back(ch);
+                }
+                Check(RunGather(src, frames, bytes, channels, reversed, reference), "GatherChannels(reversed)", bytes,
+                      channels, frames);
+                Check(RunGather(src, frames, bytes, channels, strided, reference), "GatherChannels(strided)", bytes,
+                      channels, frames);
+            }
+        }
+    }
+
+    std::printf("%d checks, %d failures\n", g_checks, g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// resampler_test.cpp : 多相FIR重采样的输出帧数、音质和分块一致性测试
+//
+// - OutputFrames与整段处理（Process + Finish）得到的帧数符合ceil(n * up / down)
+// - 1 kHz正弦重采样后与理想正弦的误差、输出奈奎斯特频率以上的输入被滤除的程度
+// - 按1/333/4096个样本分块输入与一次输入整段的结果逐样本相同
+
+#include "resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// 1 kHz正弦与理想值的最大误差上限（dBFS），约为16位的1 LSB
+const double kMaxToneErrorDb = -85.0;
+
+// 输出奈奎斯特频率以上的正弦经重采样后剩余的幅度上限（相对于输入幅度）
+const double kMaxAliasDb = -85.0;
+
+// 输出两端受补零影响的样本数，不计入误差
+const size_t kEdge = 200;
+
+int g_failures = 0;
+
+void Fail(const char* format, double a, double b) {
+    std::fprintf(stderr, "FAIL ");
+    std::fprintf(stderr, format, a, b);
+    std::fprintf(stderr, "\n");
+    ++g_failures;
+}
+
+std::vector<float> Sine(double frequency, uint32_t rate, size_t count, double amplitude) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = static_cast<float>(amplitude * std::sin(2.0 * kPi * frequency * i / rate));
+    }
+    return samples;
+}
+
+// 每次最多输入piece个样本，最后调用Finish，返回全部输出
+std::vector<float> Resample(const PolyphaseFilter& filter, const std::vector<float>& input, size_t piece) {
+    ChannelResampler resampler;
+    resampler.Reset(&filter);
+    std::vector<float> output;
+    std::vector<float> buffer(resampler.MaxOutput(piece));
+    for (size_t done = 0; done < input.size(); done += piece) {
+        size_t count = std::min(piece, input.size() - done);
+        size_t produced = resampler.Process(input.data() + done, count, buffer.data());
+        output.insert(output.end(), buffer.begin(), buffer.begin() + produced);
+    }
+    buffer.resize(resampler.MaxOutput(0));
+    size_t produced = resampler.Finish(buffer.data());
+    output.insert(output.end(), buffer.begin(), buffer.begin() + produced);
+    return output;
+}
+
+double ToDb(double value) {
+    return value > 0.0 ? 20.0 * std::log10(value) : -1000.0;
+}
+
+void CheckOutputFrames(uint32_t input_rate, uint32_t output_rate, uint64_t input_frames, uint64_t expected) {
+    PolyphaseFilter filter;
+    if (!filter.Design(input_rate, output_rate)) {
+        Fail("Design(%.0f, %.0f) failed", input_rate, output_rate);
+        return;
+    }
+    uint64_t frames = filter.OutputFrames(input_frames);
+    if (frames != expected) {
+        std::fprintf(stderr, "FAIL OutputFrames %u->%u of %llu: %llu, expected %llu\n", input_rate, output_rate,
+                     static_cast<unsigned long long>(input_frames), static_cast<unsigned long long>(frames),
+                     static_cast<unsigned long long>(expected));
+        ++g_failures;
+    }
+    // 实际处理得到的帧数与OutputFrames一致
+    std::vector<float> input(static_cast<size_t>(input_frames), 0.1f);
+    size_t produced = Resample(filter, input, 4096).size();
+    if (produced != expected) {
+        std::fprintf(stderr, "FAIL Process+Finish %u->%u of %llu: %zu frames, expected %llu\n", input_rate,
+                     output_rate, static_cast<unsigned long long>(input_frames), produced,
+                     static_cast<unsigned long long>(expected));
+        ++g_failures;
+    }
+}
+
+// 输出与理想的1 kHz正弦（零相位，输出第n个样本对应输入时刻n * down / up）比较
+void CheckTone(uint32_t input_rate, uint32_t output_rate) {
+    PolyphaseFilter filter;
+    filter.Design(input_rate, output_rate);
+    const double amplitude = 0.5;
+    std::vector<float> output = Resample(filter, Sine(1000.0, input_rate, input_rate, amplitude), 4096);
+    double max_error = 0.0;
+    for (size_t n = kEdge; n + kEdge < output.size(); ++n) {
+        double expected = amplitude * std::sin(2.0 * kPi * 1000.0 * n / output_rate);
+        max_error = std::max(max_error, std::fabs(output[n] - expected));
+    }
+    double error_db = ToDb(max_error);
+    std::printf("tone %u->%u: max error %.1f dBFS\n", input_rate, output_rate, error_db);
+    if (error_db > kMaxToneErrorDb) {
+        Fail("tone error %.1f dBFS, limit %.1f dBFS", error_db, kMaxToneErrorDb);
+    }
+}
+
+// 频率高于输出奈奎斯特频率的正弦应当被滤除，不能混叠到通带中
+void CheckAlias(uint32_t input_rate, uint32_t output_rate, double frequency) {
+    PolyphaseFilter filter;
+    filter.Design(input_rate, output_rate);
+    const double amplitude = 0.9;
+    std::vector<float> output = Resample(filter, Sine(frequency, input_rate, input_rate, amplitude), 4096);
+    double peak = 0.0;
+    for (size_t n = kEdge; n + kEdge < output.size(); ++n) {
+        peak = std::max(peak, static_cast<double>(std::fabs(output[n])));
+    }
+    double alias_db = ToDb(peak / amplitude);
+    std::printf("alias %u->%u at %.0f Hz: %.1f dB\n", input_rate, output_rate, frequency, alias_db);
+    if (alias_db > kMaxAliasDb) {
+        Fail("alias %.1f dB, limit %.1f dB", alias_db, kMaxAliasDb);
+    }
+}
+
+// 分块输入的结果必须与整段输入逐样本相同
+void CheckPieces(uint32_t input_rate, uint32_t output_rate) {
+    PolyphaseFilter filter;
+    filter.Design(input_rate, output_rate);
+    std::vector<float> input(20011);
+    uint32_t seed = 7;
+    for (auto& value : input) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+    }
+    std::vector<float> whole = Resample(filter, input, input.size());
+    for (size_t piece : {1, 333, 4096}) {
+        if (Resample(filter, input, piece) != whole) {
+            Fail("%.0f->%.0f: piecewise output differs from whole-buffer output", input_rate, output_rate);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    CheckOutputFrames(48000, 16000, 48000, 16000);
+    CheckOutputFrames(48000, 16000, 48001, 16001);
+    CheckOutputFrames(48000, 16000, 1, 1);
+    CheckOutputFrames(44100, 16000, 44100, 16000);
+    CheckOutputFrames(44100, 16000, 441, 160);
+    CheckOutputFrames(44100, 16000, 442, 161);
+    CheckOutputFrames(16000, 48000, 16000, 48000);
+    CheckOutputFrames(16000, 48000, 1, 3);
+
+    CheckTone(48000, 16000);
+    CheckTone(44100, 16000);
+    CheckTone(16000, 48000);
+
+    CheckAlias(48000, 16000, 12000.0);
+    CheckAlias(48000, 16000, 9000.0);
+    CheckAlias(44100, 16000, 15000.0);
+
+    CheckPieces(48000, 16000);
+    CheckPieces(44100, 16000);
+    CheckPieces(16000, 48000);
+
+    std::printf("%d failures\n", g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
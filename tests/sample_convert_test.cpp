@@ -0,0 +1,84 @@
+// sample_convert_test.cpp : 样本格式转换的SIMD路径与标量路径一致性测试
+//
+// 连续输出（dst_stride等于样本大小）走SIMD路径，交织输出（dst_stride更大）走标量路径，
+// 同一输入在两种间隔下的结果必须相同；NaN、无穷大和超出满幅的样本放在块内的每个位置上检查
+
+#include "sample_convert.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace {
+
+const SampleType kTargets[] = {SampleType::UInt8, SampleType::Int16, SampleType::Int24, SampleType::Int32};
+const char* const kTargetNames[] = {"uint8", "int16", "int24", "int32"};
+
+int g_failures = 0;
+
+// 转换count个浮点样本，按stride字节间隔写出后再取回连续的结果
+std::vector<uint8_t> Convert(const std::vector<float>& samples, SampleType target, size_t stride, bool dither) {
+    size_t bytes = SampleTypeBytes(target);
+    std::vector<uint8_t> interleaved(samples.size() * stride);
+    FloatToSamples(samples.data(), samples.size(), interleaved.data(), stride, target, dither, 1000, 3);
+    std::vector<uint8_t> packed(samples.size() * bytes);
+    for (size_t i = 0; i < samples.size(); ++i) {
+        std::memcpy(packed.data() + i * bytes, interleaved.data() + i * stride, bytes);
+    }
+    return packed;
+}
+
+void CheckSamePaths(const std::vector<float>& samples, const char* what) {
+    for (size_t t = 0; t < sizeof(kTargets) / sizeof(kTargets[0]); ++t) {
+        size_t bytes = SampleTypeBytes(kTargets[t]);
+        for (bool dither : {false, true}) {
+            if (Convert(samples, kTargets[t], bytes, dither) != Convert(samples, kTargets[t], bytes * 3, dither)) {
+                std::fprintf(stderr, "FAIL %s %s%s: contiguous and strided output differ\n", what,
+                             kTargetNames[t], dither ? " dither" : "");
+                ++g_failures;
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    // 普通样本，含超出满幅和恰好满幅的值
+    std::vector<float> samples(1037);
+    uint32_t seed = 1;
+    for (auto& value : samples) {
+        seed = seed * 1664525u + 1013904223u;
+        value = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 2.5f;
+    }
+    samples[5] = 1.0f;
+    samples[6] = -1.0f;
+    CheckSamePaths(samples, "random");
+
+    // 特殊值放在SIMD组内的每个位置上
+    const float specials[] = {std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(),
+                              std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+    for (float special : specials) {
+        for (size_t position = 0; position < 19; ++position) {
+            std::vector<float> block(19, 0.25f);
+            block[position] = special;
+            CheckSamePaths(block, std::isnan(special) ? "nan" : "inf");
+        }
+    }
+
+    // NaN转换为0（8位格式为0x80），不抖动时与输入0.0相同
+    std::vector<float> nans(21, std::numeric_limits<float>::quiet_NaN());
+    std::vector<float> zeros(21, 0.0f);
+    for (size_t t = 0; t < sizeof(kTargets) / sizeof(kTargets[0]); ++t) {
+        size_t bytes = SampleTypeBytes(kTargets[t]);
+        if (Convert(nans, kTargets[t], bytes, false) != Convert(zeros, kTargets[t], bytes, false) ||
+            Convert(nans, kTargets[t], bytes * 2, false) != Convert(zeros, kTargets[t], bytes * 2, false)) {
+            std::fprintf(stderr, "FAIL nan %s: not converted to silence\n", kTargetNames[t]);
+            ++g_failures;
+        }
+    }
+
+    std::printf("%d failures\n", g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,758 @@
+// wav_split_cli.cpp : 命令行批量通道分离工具，与图形界面共用AudioProcessor
+//
+// 用法: wav_split_cli [选项] <文件|目录|通配符>...
+// 每个文件输出一行JSON结果，最后输出一行汇总
+
+#include "audio_processor.h"
+#include "directory_scanner.h"
+#include "file_scheduler.h"
+#include "progress_registry.h"
+#include "split_cache.h"
+#include "split_pipeline.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cwctype>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CliOptions {
+    AudioProcessor::AudioFormat format;
+    AudioProcessor::OutputFormat output_format = AudioProcessor::OutputFormat::PCM;
+    AudioProcessor::InputMode input_mode = AudioProcessor::InputMode::Stream;
+    size_t buffer_size = 4 * 1024 * 1024;
+    std::wstring suffix;
+    AudioProcessor::ChannelMap channel_map;  // 为空时每个通道各输出一个文件
+    AudioProcessor::SampleFormat sample_format = AudioProcessor::SampleFormat::Source;
+    bool dither = false;
+    uint32_t output_sample_rate = 0;    // 0表示与源文件相同
+    AudioProcessor::StatsMode stats_mode = AudioProcessor::StatsMode::Off;
+    bool skip_silent = false;           // 不保留静音通道的输出文件
+    double silence_threshold = -INFINITY;   // 静音阈值（dBFS），默认只有数字静音
+    int thread_count = 5;
+    int split_threads = 0;  // 0表示自动：文件数少于线程数时把剩余线程用于单文件内部并行
+    bool show_progress = false;
+    bool sniff_headers = false;
+    bool probe_only = false;    // 只解析文件头并输出格式信息，不拆分
+    std::wstring cache_path;    // 拆分记录文件，为空时不使用
+    bool cache_hash = false;    // 记录中加入文件开头和末尾的内容哈希
+    bool force = false;         // 忽略拆分记录，全部重新拆分
+    bool use_pipeline = false;  // 各工作线程的数据块交给共享的读取/分离/写入流水线
+    SplitPipeline::Options pipeline;
+    std::vector<std::string> inputs;
+};
+
+// 调度器中的任务，目录扫描期间陆续提交
+struct CliTask {
+    size_t index = 0;  // 文件编号，即进度表中的槽位
+    std::wstring path;
+};
+
+struct FileResult {
+    bool success = false;
+    const char* error = "";
+    double seconds = 0.0;
+    uint64_t bytes = 0;
+    SplitMetrics metrics;
+    std::vector<ChannelStats> stats;
+    std::vector<AudioProcessor::SilentOutput> silent;
+};
+
+void PrintUsage() {
+    std::fprintf(stderr,
+        "Usage: wav_split_cli [options] <file|directory|glob>...\n"
+        "\n"
+        "Options:\n"
+        "  -r, --sample-rate <hz>    8000/16000/22050/44100/48000 (default 16000)\n"
+        "  -b, --bits <n>            8/16/24/32 (default 16)\n"
+        "  -c, --channels <n>        channel count (default 2)\n"
+        "  -s, --suffix <text>       output name suffix (default empty)\n"
+        "  -f, --format <wav|pcm>    output format (default pcm)\n"
+        "      --map <map>           channels to write, 1-based: \"1,3\" writes only ch1 and ch3,\n"
+        "                            \"1+2,3\" writes ch1+ch2 as one stereo file and ch3 alone\n"
+        "      --sample-format <fmt> source|int16|int24|int32|float32 (default source)\n"
+        "      --dither              add TPDF dither when reducing precision\n"
+        "      --resample <hz>       resample outputs to this rate (e.g. 48000 -> 16000)\n"
+        "      --stats <json|csv>    per-channel peak/RMS/DC/clipping/zero-run computed during\n"
+        "                            the split, written next to each input and to the result line\n"
+        "      --skip-silent         do not keep outputs whose channels are all silent; they are\n"
+        "                            listed under \"silent\" in the result line instead\n"
+        "      --silence-threshold <dbfs>  peak at or below which a channel counts as silent\n"
+        "                            (default: digital silence only)\n"
+        "  -j, --threads <n>         worker threads (default 5)\n"
+        "  -J, --split-threads <n>   threads per file (default auto)\n"
+        "  -m, --input-mode <mode>   memory|stream|mapped (default stream)\n"
+        "      --buffer <bytes>      block buffer size (default 4194304)\n"
+        "  -p, --progress            print overall progress to stderr\n"
+        "      --sniff               skip .wav files without a RIFF/WAVE header\n"
+        "      --probe               print format, frames and data offset of each file\n"
+        "                            from its header only, without splitting\n"
+        "      --cache <file>        skip inputs whose size, mtime, settings and outputs\n"
+        "                            match the manifest from an earlier run\n"
+        "      --cache-hash          also compare a hash of the first and last 64 KiB\n"
+        "      --force               re-split every input and rewrite the manifest entries\n"
+        "      --pipeline <r,d,w>    pipelined read/deinterleave/write stages with r/d/w threads\n"
+        "      --inflight <n>        blocks in flight in the pipeline (default 16)\n"
+        "  -h, --help                show this help\n"
+        "\n"
+        "Directories are searched recursively for .wav/.pcm files in the background;\n"
+        "files are processed as soon as they are found.\n"
+        "Results are printed to stdout as one JSON object per line.\n");
+}
+
+bool ParseInt(const char* text, long long min_value, long long& value) {
+    char* end = nullptr;
+    long long parsed = std::strtoll(text, &end, 10);
+    if (!end || *end != '\0' || parsed < min_value) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// 解析命令行，出错时返回false
+bool ParseArguments(int argc, char** argv, CliOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](const char*& value) {
+            if (i + 1 >= argc) {
+                std::fprintf(stderr, "missing value for %s\n", arg.c_str());
+                return false;
+            }
+            value = argv[++i];
+            return true;
+        };
+
+        const char* value = nullptr;
+        long long number = 0;
+        if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            std::exit(0);
+        } else if (arg == "-r" || arg == "--sample-rate") {
+            if (!next(value) || !ParseInt(value, 1, number)) return false;
+            options.format.sample_rate = static_cast<uint32_t>(number);
+        } else if (arg == "-b" || arg == "--bits") {
+            if (!next(value) || !ParseInt(value, 8, number) || number % 8 != 0 || number > 32) {
+                std::fprintf(stderr, "bits must be 8, 16, 24 or 32\n");
+                return false;
+            }
+            options.format.bits_per_sample = static_cast<uint16_t>(number);
+        } else if (arg == "-c" || arg == "--channels") {
+            if (!next(value) || !ParseInt(value, 1, number) || number > 65535) return false;
+            options.format.num_channels = static_cast<uint16_t>(number);
+        } else if (arg == "-s" || arg == "--suffix") {
+            if (!next(value)) return false;
+            options.suffix = fs::path(value).wstring();
+        } else if (arg == "--map") {
+            if (!next(value) || !AudioProcessor::ParseChannelMap(fs::path(value).wstring(), options.channel_map)) {
+                std::fprintf(stderr, "invalid channel map\n");
+                return false;
+            }
+        } else if (arg == "--sample-format") {
+            if (!next(value)) return false;
+            std::string format = value;
+            if (format == "source") {
+                options.sample_format = AudioProcessor::SampleFormat::Source;
+            } else if (format == "int16") {
+                options.sample_format = AudioProcessor::SampleFormat::Int16;
+            } else if (format == "int24") {
+                options.sample_format = AudioProcessor::SampleFormat::Int24;
+            } else if (format == "int32") {
+                options.sample_format = AudioProcessor::SampleFormat::Int32;
+            } else if (format == "float32") {
+                options.sample_format = AudioProcessor::SampleFormat::Float32;
+            } else {
+                std::fprintf(stderr, "unknown sample format: %s\n", value);
+                return false;
+            }
+        } else if (arg == "--dither") {
+            options.dither = true;
+        } else if (arg == "--resample") {
+            if (!next(value) || !ParseInt(value, 1, number) || number > 1000000) return false;
+            options.output_sample_rate = static_cast<uint32_t>(number);
+        } else if (arg == "--stats") {
+            if (!next(value)) return false;
+            std::string mode = value;
+            if (mode == "json") {
+                options.stats_mode = AudioProcessor::StatsMode::Json;
+            } else if (mode == "csv") {
+                options.stats_mode = AudioProcessor::StatsMode::Csv;
+            } else {
+                std::fprintf(stderr, "unknown stats format: %s\n", value);
+                return false;
+            }
+        } else if (arg == "--skip-silent") {
+            options.skip_silent = true;
+        } else if (arg == "--silence-threshold") {
+            if (!next(value)) return false;
+            char* end = nullptr;
+            double threshold = std::strtod(value, &end);
+            if (!end || *end != '\0' || threshold > 0.0) {
+                std::fprintf(stderr, "invalid silence threshold: %s\n", value);
+                return false;
+            }
+            options.silence_threshold = threshold;
+            options.skip_silent = true;
+        } else if (arg == "-f" || arg == "--format") {
+            if (!next(value)) return false;
+            std::string format = value;
+            if (format == "wav") {
+                options.output_format = AudioProcessor::OutputFormat::WAV;
+            } else if (format == "pcm") {
+                options.output_format = AudioProcessor::OutputFormat::PCM;
+            } else {
+                std::fprintf(stderr, "unknown output format: %s\n", value);
+                return false;
+            }
+        } else if (arg == "-j" || arg == "--threads") {
+            if (!next(value) || !ParseInt(value, 1, number)) return false;
+            options.thread_count = static_cast<int>(number);
+        } else if (arg == "-J" || arg == "--split-threads") {
+            if (!next(value) || !ParseInt(value, 1, number)) return false;
+            options.split_threads = static_cast<int>(number);
+        } else if (arg == "-m" || arg == "--input-mode") {
+            if (!next(value)) return false;
+            std::string mode = value;
+            if (mode == "memory") {
+                options.input_mode = AudioProcessor::InputMode::Memory;
+            } else if (mode == "stream") {
+                options.input_mode = AudioProcessor::InputMode::Stream;
+            } else if (mode == "mapped") {
+                options.input_mode = AudioProcessor::InputMode::Mapped;
+            } else {
+                std::fprintf(stderr, "unknown input mode: %s\n", value);
+                return false;
+            }
+        } else if (arg == "--buffer") {
+            if (!next(value) || !ParseInt(value, 1, number)) return false;
+            options.buffer_size = static_cast<size_t>(number);
+        } else if (arg == "-p" || arg == "--progress") {
+            options.show_progress = true;
+        } else if (arg == "--sniff") {
+            options.sniff_headers = true;
+        } else if (arg == "--probe") {
+            options.probe_only = true;
+        } else if (arg == "--cache") {
+            if (!next(value)) return false;
+            options.cache_path = fs::u8path(value).wstring();
+        } else if (arg == "--cache-hash") {
+            options.cache_hash = true;
+        } else if (arg == "--force") {
+            options.force = true;
+        } else if (arg == "--pipeline") {
+            int readers = 0, deinterleavers = 0, writers = 0;
+            char extra;
+            if (!next(value) ||
+                std::sscanf(value, "%d,%d,%d%c", &readers, &deinterleavers, &writers, &extra) != 3 ||
+                readers < 1 || deinterleavers < 1 || writers < 1) {
+                std::fprintf(stderr, "pipeline must be <readers>,<deinterleavers>,<writers>\n");
+                return false;
+            }
+            options.use_pipeline = true;
+            options.pipeline.reader_threads = readers;
+            options.pipeline.deinterleave_threads = deinterleavers;
+            options.pipeline.writer_threads = writers;
+        } else if (arg == "--inflight") {
+            if (!next(value) || !ParseInt(value, 1, number)) return false;
+            options.pipeline.max_blocks = static_cast<size_t>(number);
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::fprintf(stderr, "unknown option: %s\n", arg.c_str());
+            return false;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    return !options.inputs.empty();
+}
+
+// 简单通配符匹配，支持*和?
+bool WildcardMatch(const std::wstring& pattern, const std::wstring& text) {
+    size_t p = 0, t = 0, star = std::wstring::npos, mark = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == L'?' || pattern[p] == text[t])) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == L'*') {
+            star = p++;
+            mark = t;
+        } else if (star != std::wstring::npos) {
+            p = star + 1;
+            t = ++mark;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == L'*') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+// 将文件和通配符展开为文件列表，目录留给后台扫描
+void CollectInputs(const std::vector<std::string>& inputs, std::vector<DirectoryScanner::Entry>& files,
+                   std::vector<std::wstring>& directories) {
+    auto add = [&](const fs::path& path) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(path, ec);
+        files.push_back({path.wstring(), ec ? 0 : size});
+    };
+
+    for (const auto& input : inputs) {
+        fs::path path(input);
+        std::error_code ec;
+        std::wstring name = path.filename().wstring();
+        if (name.find_first_of(L"*?") != std::wstring::npos) {
+            fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+            for (const auto& entry : fs::directory_iterator(dir, ec)) {
+                if (entry.is_regular_file(ec) && WildcardMatch(name, entry.path().filename().wstring())) {
+                    add(entry.path());
+                }
+            }
+        } else if (fs::is_directory(path, ec)) {
+            directories.push_back(path.wstring());
+        } else {
+            // 不存在的文件也加入列表，由处理阶段报告加载失败
+            add(path);
+        }
+    }
+}
+
+std::string JsonEscape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size() + 2);
+    for (unsigned char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    escaped += buf;
+                } else {
+                    escaped += static_cast<char>(c);
+                }
+        }
+    }
+    return escaped;
+}
+
+std::string ToUtf8(const std::wstring& text) {
+    return fs::path(text).u8string();
+}
+
+// 各阶段统计的JSON对象
+std::string MetricsJson(const SplitMetrics& metrics) {
+    char buf[640];
+    std::snprintf(buf, sizeof(buf),
+        "{\"bytes_read\":%llu,\"bytes_written\":%llu,"
+        "\"load_seconds\":%.6f,\"load_cpu_seconds\":%.6f,"
+        "\"read_seconds\":%.6f,\"read_cpu_seconds\":%.6f,"
+        "\"deinterleave_seconds\":%.6f,\"deinterleave_cpu_seconds\":%.6f,"
+        "\"write_seconds\":%.6f,\"write_cpu_seconds\":%.6f,\"write_wait_seconds\":%.6f,"
+        "\"split_seconds\":%.6f,\"allocation_count\":%llu,\"allocated_bytes\":%llu,\"peak_buffer_bytes\":%llu}",
+        static_cast<unsigned long long>(metrics.bytes_read), static_cast<unsigned long long>(metrics.bytes_written),
+        metrics.load_seconds, metrics.load_cpu_seconds,
+        metrics.read_seconds, metrics.read_cpu_seconds,
+        metrics.deinterleave_seconds, metrics.deinterleave_cpu_seconds,
+        metrics.write_seconds, metrics.write_cpu_seconds, metrics.write_wait_seconds,
+        metrics.split_seconds, static_cast<unsigned long long>(metrics.allocation_count),
+        static_cast<unsigned long long>(metrics.allocated_bytes),
+        static_cast<unsigned long long>(metrics.peak_buffer_bytes));
+    return buf;
+}
+
+// 处理单个文件，流程与图形界面的工作线程一致
+FileResult ProcessFile(AudioProcessor& processor, const std::wstring& file, const CliOptions& options) {
+    FileResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    std::error_code ec;
+    uint64_t size = fs::file_size(file, ec);
+    result.bytes = ec ? 0 : size;
+
+    // PCM输入的文件头由加载时的格式决定，WAV输入加载后再覆盖为用户设置
+    processor.SetAudioFormat(options.format);
+    if (!processor.LoadWavFile(file)) {
+        result.error = "load failed";
+    } else {
+        processor.SetAudioFormat(options.format);
+        processor.SetOutputFormat(options.output_format);
+        if (!processor.SplitChannels(fs::path(file).parent_path().wstring(), options.suffix)) {
+            result.error = "split failed";
+        } else {
+            result.success = true;
+        }
+    }
+    result.metrics = processor.GetLastMetrics();
+    result.stats = processor.GetLastChannelStats();
+    result.silent = processor.GetSilentOutputs();
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// 探测全部输入文件（含目录扫描结果）的文件头，每个文件输出一行JSON，最后输出汇总
+int RunProbe(const CliOptions& options, const std::vector<DirectoryScanner::Entry>& files,
+             const std::vector<std::wstring>& directories) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::wstring> paths;
+    std::set<std::wstring> seen;
+    auto add = [&](const std::vector<DirectoryScanner::Entry>& batch) {
+        for (const auto& entry : batch) {
+            std::wstring normalized = fs::path(entry.path).lexically_normal().wstring();
+            if (seen.insert(normalized).second) {
+                paths.push_back(std::move(normalized));
+            }
+        }
+    };
+    add(files);
+
+    if (!directories.empty()) {
+        // 扫描线程回调的顺序不确定，目录中的文件按路径排序后输出
+        std::vector<DirectoryScanner::Entry> found;
+        std::mutex found_mutex;
+        DirectoryScanner::Options scan_options;
+        scan_options.sniff_wav_headers = options.sniff_headers;
+        DirectoryScanner scanner(options.thread_count, scan_options, [&](std::vector<DirectoryScanner::Entry>& batch) {
+            std::lock_guard<std::mutex> lock(found_mutex);
+            found.insert(found.end(), batch.begin(), batch.end());
+        });
+        for (const auto& directory : directories) {
+            scanner.Scan(directory);
+        }
+        scanner.Wait();
+        std::sort(found.begin(), found.end(), [](const DirectoryScanner::Entry& a, const DirectoryScanner::Entry& b) {
+            return a.path < b.path;
+        });
+        add(found);
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "no input files\n");
+        return 2;
+    }
+
+    std::vector<AudioProcessor::ProbeInfo> infos =
+        AudioProcessor::ProbeFiles(paths, options.format, options.thread_count);
+
+    size_t invalid = 0;
+    uint64_t data_bytes = 0;
+    double duration = 0.0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const AudioProcessor::ProbeInfo& info = infos[i];
+        if (!info.valid) {
+            ++invalid;
+            std::printf("{\"file\":\"%s\",\"status\":\"error\",\"error\":\"invalid header\",\"bytes\":%llu}\n",
+                        JsonEscape(ToUtf8(paths[i])).c_str(), static_cast<unsigned long long>(info.file_size));
+            continue;
+        }
+        data_bytes += info.data_size;
+        duration += info.duration_seconds;
+        std::printf("{\"file\":\"%s\",\"status\":\"ok\",\"type\":\"%s\",\"sample_rate\":%u,\"bits\":%u,"
+                    "\"channels\":%u,\"format_tag\":%u,\"sub_format\":%u,\"bytes\":%llu,\"data_offset\":%llu,"
+                    "\"data_size\":%llu,\"frames\":%llu,\"duration\":%.6f}\n",
+                    JsonEscape(ToUtf8(paths[i])).c_str(), info.is_wav ? "wav" : "pcm",
+                    static_cast<unsigned>(info.format.sample_rate), static_cast<unsigned>(info.format.bits_per_sample),
+                    static_cast<unsigned>(info.format.num_channels),
+                    static_cast<unsigned>(info.source_format.format_tag),
+                    static_cast<unsigned>(info.source_format.sub_format),
+                    static_cast<unsigned long long>(info.file_size),
+                    static_cast<unsigned long long>(info.data_offset),
+                    static_cast<unsigned long long>(info.data_size),
+                    static_cast<unsigned long long>(info.frames), info.duration_seconds);
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("{\"summary\":{\"files\":%zu,\"valid\":%zu,\"invalid\":%zu,\"data_bytes\":%llu,"
+                "\"duration\":%.6f,\"seconds\":%.6f,\"threads\":%d}}\n",
+                paths.size(), paths.size() - invalid, invalid, static_cast<unsigned long long>(data_bytes),
+                duration, elapsed, options.thread_count);
+    return invalid > 0 ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CliOptions options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<DirectoryScanner::Entry> files;
+    std::vector<std::wstring> directories;
+    CollectInputs(options.inputs, files, directories);
+    if (files.empty() && directories.empty()) {
+        std::fprintf(stderr, "no input files\n");
+        return 2;
+    }
+    if (options.probe_only) {
+        return RunProbe(options, files, directories);
+    }
+
+    // 上次运行的拆分记录，输入和输出都没有变化的文件直接跳过
+    std::unique_ptr<SplitCache> cache;
+    if (!options.cache_path.empty()) {
+        cache = std::make_unique<SplitCache>();
+        cache->SetUseHash(options.cache_hash);
+        if (!cache->Load(options.cache_path)) {
+            std::fprintf(stderr, "cannot read cache: %s\n", ToUtf8(options.cache_path).c_str());
+            return 2;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    // 没有目录时文件数已知，线程数不超过文件数；有目录时边扫描边处理
+    int thread_count = directories.empty()
+        ? std::max(1, std::min<int>(options.thread_count, static_cast<int>(files.size())))
+        : std::max(1, options.thread_count);
+
+    // 按文件大小提交给调度器，大文件优先，空闲线程从其他队列窃取
+    FileScheduler<CliTask> scheduler;
+    scheduler.Start(thread_count);
+
+    std::atomic<int> failed_files(0);
+    std::atomic<int> completed_files(0);
+    std::atomic<int> skipped_files(0);
+    std::atomic<int> silent_outputs(0);
+    std::atomic<size_t> found_files(0);
+    std::atomic<bool> scan_done(directories.empty());
+    std::atomic<uint64_t> total_bytes(0);
+    ProgressRegistry progress;
+    SplitMetricsSummary summary;
+    std::mutex output_mutex;
+
+    // 去重后分配文件编号并提交，目录扫描的批次由扫描线程依次调用
+    std::set<std::wstring> seen;
+    std::mutex seen_mutex;
+    auto submit = [&](std::vector<DirectoryScanner::Entry>& batch) {
+        std::vector<FileScheduler<CliTask>::Item> items;
+        items.reserve(batch.size());
+        std::lock_guard<std::mutex> lock(seen_mutex);
+        size_t first = found_files.load();
+        for (auto& entry : batch) {
+            std::wstring normalized = fs::path(entry.path).lexically_normal().wstring();
+            if (!seen.insert(normalized).second) {
+                continue;
+            }
+            // 记录中的输出文件是上次运行生成的，不作为输入
+            if (cache && cache->IsOutput(normalized)) {
+                continue;
+            }
+            FileScheduler<CliTask>::Item item;
+            item.task.index = first + items.size();
+            item.task.path = std::move(normalized);
+            item.size = entry.size;
+            items.push_back(std::move(item));
+        }
+        // 总进度按文件大小加权，大文件完成一半与小文件完成一半对总进度的贡献不同
+        progress.Grow(first + items.size());
+        for (const auto& item : items) {
+            progress.SetWeight(item.task.index, item.size);
+        }
+        found_files = first + items.size();
+        scheduler.Submit(std::move(items));
+    };
+    submit(files);
+
+    // 所有工作线程共用一条流水线，在途块数限制了总的缓冲区占用
+    std::shared_ptr<SplitPipeline> pipeline;
+    if (options.use_pipeline) {
+        options.pipeline.block_bytes = options.buffer_size;
+        pipeline = std::make_shared<SplitPipeline>(options.pipeline);
+    }
+
+    auto worker = [&](int worker_index) {
+        // 每个线程使用自己的AudioProcessor实例
+        AudioProcessor processor;
+        processor.SetInputMode(options.input_mode);
+        processor.SetStreamBufferSize(options.buffer_size);
+        processor.SetPipeline(pipeline);
+        processor.SetChannelMap(options.channel_map);
+        processor.SetSampleFormat(options.sample_format);
+        processor.SetDither(options.dither);
+        processor.SetOutputSampleRate(options.output_sample_rate);
+        processor.SetStatsMode(options.stats_mode);
+        processor.SetSkipSilentOutputs(options.skip_silent);
+        processor.SetSilenceThreshold(options.silence_threshold);
+        processor.SetAudioFormat(options.format);
+        processor.SetOutputFormat(options.output_format);
+        std::string settings = processor.MakeSettingsKey(options.suffix);
+
+        CliTask task;
+        while (scheduler.Next(worker_index, task)) {
+            // 自动模式下扫描结束后才知道文件总数，扫描期间每个文件单线程拆分
+            int split_threads = options.split_threads;
+            if (split_threads <= 0) {
+                split_threads = scan_done
+                    ? std::max(1, options.thread_count / static_cast<int>(std::max<size_t>(1, found_files.load())))
+                    : 1;
+            }
+            processor.SetSplitThreads(split_threads);
+
+            // 输出文件写在输入文件旁边，扫描仍在进行时先把输出路径登记为已见过，
+            // 避免扫描线程把本次生成的输出当作新的输入
+            if (!scan_done) {
+                std::lock_guard<std::mutex> lock(seen_mutex);
+                if (options.channel_map.empty()) {
+                    for (int ch = 0; ch < options.format.num_channels; ++ch) {
+                        seen.insert(fs::path(AudioProcessor::MakeOutputPath(task.path, ch, options.suffix,
+                                                                            options.output_format))
+                                        .lexically_normal().wstring());
+                    }
+                }
+                for (const auto& channels : options.channel_map) {
+                    seen.insert(fs::path(AudioProcessor::MakeOutputPath(task.path, channels, options.suffix,
+                                                                        options.output_format))
+                                    .lexically_normal().wstring());
+                }
+            }
+
+            size_t index = task.index;
+
+            // 输入状态在拆分之前取得，拆分期间文件被修改时下次运行不会误判为最新
+            SplitCache::InputState state;
+            bool cacheable = cache && cache->Stat(task.path, state);
+            if (cacheable && !options.force && cache->IsUpToDate(task.path, state, settings)) {
+                progress.Set(index, 100);
+                skipped_files++;
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::printf("{\"file\":\"%s\",\"status\":\"skipped\",\"error\":\"\",\"bytes\":%llu}\n",
+                            JsonEscape(ToUtf8(task.path)).c_str(), static_cast<unsigned long long>(state.size));
+                std::fflush(stdout);
+                completed_files++;
+                continue;
+            }
+
+            processor.SetProgressCallback([&progress, index](int percent) {
+                progress.Set(index, percent);
+            });
+            FileResult result = ProcessFile(processor, task.path, options);
+            if (cache) {
+                if (result.success && cacheable) {
+                    cache->Record(task.path, state, settings, processor.GetOutputPaths());
+                } else {
+                    cache->Remove(task.path);
+                }
+            }
+            if (!result.success) {
+                failed_files++;
+                progress.Set(index, ProgressRegistry::kSplitFailed);
+            } else {
+                progress.Set(index, 100);
+            }
+            total_bytes += result.bytes;
+            summary.Add(result.metrics);
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            std::string extra;
+            if (options.stats_mode != AudioProcessor::StatsMode::Off && result.success) {
+                extra = ",\"stats\":" + ChannelStatsJson(result.stats);
+            }
+            // 被跳过的静音输出及其源通道（从1开始）
+            if (options.skip_silent && result.success) {
+                extra += ",\"silent\":[";
+                for (size_t i = 0; i < result.silent.size(); ++i) {
+                    extra += (i > 0 ? ",{\"file\":\"" : "{\"file\":\"") +
+                             JsonEscape(ToUtf8(result.silent[i].path)) + "\",\"channels\":[";
+                    for (size_t k = 0; k < result.silent[i].channels.size(); ++k) {
+                        extra += (k > 0 ? "," : "") + std::to_string(result.silent[i].channels[k] + 1);
+                    }
+                    extra += "]}";
+                }
+                extra += "]";
+                silent_outputs += static_cast<int>(result.silent.size());
+            }
+            std::printf("{\"file\":\"%s\",\"status\":\"%s\",\"error\":\"%s\",\"bytes\":%llu,\"seconds\":%.6f,\"metrics\":%s%s}\n",
+                        JsonEscape(ToUtf8(task.path)).c_str(), result.success ? "ok" : "error",
+                        result.error, static_cast<unsigned long long>(result.bytes), result.seconds,
+                        MetricsJson(result.metrics).c_str(), extra.c_str());
+            std::fflush(stdout);
+            completed_files++;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back(worker, i);
+    }
+
+    // 目录在后台并行扫描，找到的文件立即提交，工作线程不必等扫描结束
+    std::unique_ptr<DirectoryScanner> scanner;
+    if (!directories.empty()) {
+        DirectoryScanner::Options scan_options;
+        scan_options.sniff_wav_headers = options.sniff_headers;
+        scanner = std::make_unique<DirectoryScanner>(options.thread_count, scan_options, submit);
+        for (const auto& directory : directories) {
+            scanner->Scan(directory);
+        }
+    }
+    // 扫描结束、全部文件提交后关闭调度器，队列处理完后工作线程退出
+    bool scheduler_closed = false;
+    auto finish_scan = [&] {
+        if (scanner) {
+            scanner->Wait();
+        }
+        scan_done = true;
+        scheduler.Close();
+        scheduler_closed = true;
+    };
+
+    if (options.show_progress) {
+        // 定期从进度表取总进度，进度没有变化时不输出；扫描期间文件总数后面标“+”
+        uint64_t shown_version = 0;
+        for (;;) {
+            if (!scheduler_closed && !(scanner && scanner->Busy())) {
+                finish_scan();
+            }
+            bool done = scheduler_closed && completed_files == static_cast<int>(found_files.load());
+            uint64_t version = progress.Version();
+            if (version != shown_version) {
+                shown_version = version;
+                std::fprintf(stderr, "\rprogress: %3d%% (%d/%zu%s)", progress.OverallPercent(),
+                             completed_files.load(), found_files.load(), scheduler_closed ? "" : "+");
+            }
+            if (done) {
+                std::fprintf(stderr, "\n");
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+    } else {
+        finish_scan();
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (cache && !cache->Save()) {
+        std::fprintf(stderr, "cannot write cache: %s\n", ToUtf8(options.cache_path).c_str());
+    }
+
+    size_t file_count = found_files.load();
+    if (file_count == 0) {
+        std::fprintf(stderr, "no input files\n");
+        return 2;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("{\"summary\":{\"files\":%zu,\"succeeded\":%zu,\"failed\":%d,\"skipped\":%d,\"silent_outputs\":%d,\"bytes\":%llu,\"seconds\":%.6f,\"threads\":%d,\"metrics\":%s}}\n",
+                file_count, file_count - failed_files - skipped_files, failed_files.load(), skipped_files.load(),
+                silent_outputs.load(),
+                static_cast<unsigned long long>(total_bytes.load()), elapsed, thread_count,
+                MetricsJson(summary.Total()).c_str());
+    return failed_files > 0 ? 1 : 0;
+}